@@ -0,0 +1,297 @@
+#include "../include/system_const.h"
+#include "../include/types_bikaya.h"
+#include "../process/scheduler.h"
+#include "../process/asl.h"
+#include "disk_utils.h"
+#include "device_utils.h"
+
+
+// Mask to extract the opcode from a command (the upper bits are parameters or data)
+#define CMD_OPCODE_MASK 0xFF
+
+// Device descriptors table, the receiving side of the terminals is in the last row
+HIDDEN dev_desc_t dev_table[DEV_DESC_NUM];
+
+
+
+/*
+    Builds the device descriptors table, one descriptor for each device register
+    plus one more for each terminal (the receiving subdevice). Called once at boot.
+
+    return: void
+*/
+void init_devTable(void) {
+    for (u_int i = 0; i < DEV_DESC_NUM; i++) {
+        dev_desc_t *desc = &dev_table[i];
+        // The receiving terminals are the row after the last interrupt line
+        u_int recv = (i >> DEV_PER_INT_SHIFT) > EXT_IL_INDEX(IL_TERMINAL);
+
+        desc->line = DEV_IL_START + (i >> DEV_PER_INT_SHIFT) - recv;
+        desc->dev_no = i & (DEV_PER_INT - 1);
+        desc->recv = recv;
+        desc->reg = (devreg_t*) DEV_REG_ADDR(desc->line, desc->dev_no);
+
+        desc->wait_sem = desc->queue_sem = 0;
+        desc->reserved = FALSE;
+        desc->kernel_owned = desc->kernel_waiting = FALSE;
+        desc->busy = FALSE;
+        desc->in_flight = NULL;
+        desc->command = 0;
+        desc->busy_since = 0;
+        desc->buf = NULL;
+        desc->buf_len = desc->buf_pos = 0;
+        desc->stats.ops = desc->stats.bytes = desc->stats.busy_time = 0;
+    }
+}
+
+
+/*
+    Returns the descriptor of the device that owns the given register. The index in the
+    table is obtained with shifts only, since each register is DEV_REG_SIZE bytes long
+    and the registers of the same line are contiguous.
+
+    dev_register: the address of the device register
+    subdevice: for terminals only, 1 for recv, 0 for transm
+    return: the device descriptor, NULL if the address isn't a device register
+*/
+dev_desc_t* getDevDesc(memaddr dev_register, u_int subdevice) {
+    memaddr offset = dev_register - DEV_REG_START;
+
+    if (dev_register < DEV_REG_START || dev_register >= DEV_REG_END || (offset & (DEV_REG_SIZE - 1)))
+        return (NULL);
+
+    u_int index = offset >> DEV_REG_SHIFT;
+    // Only the terminals have a receiving subdevice
+    if (subdevice && (index >> DEV_PER_INT_SHIFT) == EXT_IL_INDEX(IL_TERMINAL))
+        index += DEV_PER_INT;
+
+    return (&dev_table[index]);
+}
+
+
+/*
+    Returns the descriptor of a device given its interrupt line and device number,
+    used by the interrupt handlers
+
+    line: the interrupt line of the device (from IL_DISK to IL_TERMINAL)
+    dev_no: the device number on the line
+    recv: for terminals only, TRUE for the receiving subdevice
+    return: the device descriptor
+*/
+dev_desc_t* getLineDesc(u_int line, u_int dev_no, u_int recv) {
+    u_int row = EXT_IL_INDEX(line) + (recv != 0);
+    return (&dev_table[(row << DEV_PER_INT_SHIFT) | dev_no]);
+}
+
+
+/*
+    Issues a command on the device described by desc and records it as the
+    request in execution
+
+    desc: the device descriptor
+    requester: the process that issued the request (NULL for kernel requests)
+    command: the command to write in the command registrer
+    return: void
+*/
+void dev_issue(dev_desc_t *desc, pcb_t *requester, u_int command) {
+    desc->busy = TRUE;
+    desc->in_flight = requester;
+    desc->command = command;
+    desc->busy_since = TOD_LO;
+
+    if (desc->line != IL_TERMINAL)
+        desc->reg->dtp.command = command;
+    else if (desc->recv)
+        desc->reg->term.recv_command = command;
+    else
+        desc->reg->term.transm_command = command;
+}
+
+
+/*
+    Starts on the device the request made by a process with WAITIO or TERMWRITE, the
+    syscall is the last one of the requester and its arguments are retrieved from the given state.
+    A disk read of a block still dirty in the cache is served by the cache, without the device.
+
+    desc: the device descriptor
+    requester: the process that made the request
+    request: the state with the syscall registers (the old area or the saved state)
+    return: TRUE if the request has been started, FALSE if it's already completed (the status is the return value)
+*/
+u_int dev_start_request(dev_desc_t *desc, pcb_t *requester, state_t *request) {
+    if (requester->p_syscall == TERMWRITE) {
+        desc->buf = (char*) SYS_ARG_1(request);
+        desc->buf_len = SYS_ARG_2(request);
+        desc->buf_pos = 0;
+        dev_issue(desc, requester, TRANSMIT_CHAR(desc->buf[0]));
+        return (TRUE);
+    }
+
+    u_int command = SYS_ARG_1(request);
+
+    if (desc->line == IL_DISK && disk_cache_request(desc->dev_no, command, desc->reg->dtp.data0)) {
+        SYS_RETURN_VAL(request) = DISK_READY;
+        return (FALSE);
+    }
+
+    dev_issue(desc, requester, command);
+    return (TRUE);
+}
+
+
+// Returns TRUE if a request is in execution on the device, or the kernel and other processes are waiting for it
+u_int dev_busy(dev_desc_t *desc) {
+    return (desc->busy || desc->kernel_owned || desc->kernel_waiting || headBlocked(&desc->queue_sem) != NULL);
+}
+
+
+/*
+    Gives the free device to the next one waiting for it: the kernel or the first process in the
+    queue (that then waits for the completion as the ones that found the device free). The kernel
+    and the processes take turns, so that a long flush of the disk cache doesn't starve the WAITIO requests.
+
+    desc: the device descriptor
+    kernel_turn: TRUE if the kernel goes before the processes in the queue
+    return: void
+*/
+HIDDEN void dev_start_next(dev_desc_t *desc, u_int kernel_turn) {
+    pcb_t *next;
+
+    // Only the disk cache uses a device on its own
+    if (desc->kernel_waiting && (kernel_turn || headBlocked(&desc->queue_sem) == NULL)) {
+        desc->kernel_waiting = FALSE;
+        desc->kernel_owned = TRUE;
+        disk_cache_resume(desc->dev_no);
+        return ;
+    }
+
+    // The requests served without the device are completed right away
+    while ((next = removeBlocked(&desc->queue_sem)) != NULL) {
+        if (dev_start_request(desc, next, &next->p_s)) {
+            insertBlocked(&desc->wait_sem, next);
+            return ;
+        }
+
+        scheduler_add(next);
+    }
+}
+
+
+/*
+    Gives the device to the kernel if it's free, else the kernel waits for its turn as the
+    processes do and disk_cache_resume is called once the device is given to it.
+    The device is owned by the kernel until dev_kernel_release, even between its commands.
+
+    desc: the device descriptor
+    return: TRUE if the kernel owns the device and can issue its commands right away
+*/
+u_int dev_kernel_acquire(dev_desc_t *desc) {
+    if (dev_busy(desc)) {
+        desc->kernel_waiting = TRUE;
+        return (FALSE);
+    }
+
+    desc->kernel_owned = TRUE;
+    return (TRUE);
+}
+
+
+/*
+    Ends the use of the device by the kernel, the device goes to the first process waiting for it
+
+    desc: the device descriptor
+    return: void
+*/
+void dev_kernel_release(dev_desc_t *desc) {
+    desc->kernel_owned = FALSE;
+    dev_start_next(desc, FALSE);
+}
+
+
+/*
+    Updates the utilisation stats of a device after the request in execution is completed
+
+    desc: the device descriptor
+    return: void
+*/
+void dev_account(dev_desc_t *desc) {
+    u_int opcode = desc->command & CMD_OPCODE_MASK;
+
+    desc->stats.ops++;
+    desc->stats.busy_time += TOD_LO - desc->busy_since;
+
+    // Disks and tapes transfer a whole block (a seek doesn't transfer anything), the others a char
+    if (desc->line == IL_DISK || desc->line == IL_TAPE)
+        desc->stats.bytes += (opcode == DISK_READBLK || opcode == DISK_WRITEBLK) ? DISK_BLOCK_SIZE : 0;
+    else if (desc->line != IL_ETHERNET)
+        desc->stats.bytes += 1;
+
+    desc->busy = FALSE;
+    desc->in_flight = NULL;
+}
+
+
+/*
+    Detaches a killed process from the request it had in execution, if any. The command already
+    issued completes without waking anyone up and the rest of a string in transmission is dropped,
+    the device stays busy till then.
+
+    p: the killed process
+    return: void
+*/
+void dev_abort(pcb_t *p) {
+    for (u_int i = 0; i < DEV_DESC_NUM; i++) {
+        dev_desc_t *desc = &dev_table[i];
+
+        if (desc->in_flight == p) {
+            desc->in_flight = NULL;
+            desc->buf = NULL;
+        }
+    }
+}
+
+
+/*
+    Completes the request in execution on the device, updating the stats and waking up
+    the first process waiting for the device with the status as WAITIO return value.
+    For a string transmission the next char is sent instead, and the caller is waken up
+    only after the last one with the number of chars transmitted.
+    NOTE: the interrupt must be already acknowledged, a new command could be issued!
+
+    desc: the device descriptor
+    status: the device status read before the acknowledgement
+    return: the unblocked process, NULL if no one was waiting (or the string isn't over)
+*/
+pcb_t* dev_complete(dev_desc_t *desc, u_int status) {
+    pcb_t *requester = desc->in_flight;
+    dev_account(desc);
+
+    if (desc->buf != NULL) {
+        u_int transmitted = (status & TERM_STATUS_MASK) == ST_TRANSMITTED;
+        transmitted ? desc->buf_pos++ : 0;
+
+        if (transmitted && desc->buf_pos < desc->buf_len) {
+            dev_issue(desc, requester, TRANSMIT_CHAR(desc->buf[desc->buf_pos]));
+            return (NULL);
+        }
+
+        // Return value from the TermWrite syscall
+        status = transmitted ? desc->buf_pos : (u_int) FAILURE;
+        desc->buf = NULL;
+    }
+
+    // The disk cache must know where the head is, the processes move it as well
+    if (desc->line == IL_DISK && (desc->command & CMD_OPCODE_MASK) == DISK_SEEKCYL)
+        disk_cache_seek_done(desc->dev_no, desc->command >> DISK_CYL_SHIFT, status);
+
+    pcb_t *unblocked = removeBlocked(&desc->wait_sem);
+
+    if (unblocked != NULL) {
+        // Return value from the Wait_IO syscall
+        SYS_RETURN_VAL(((state_t*) &unblocked->p_s)) = status;
+        scheduler_add(unblocked);
+    }
+
+    dev_start_next(desc, TRUE);
+    return (unblocked);
+}
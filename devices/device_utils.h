@@ -0,0 +1,18 @@
+#ifndef __DEVICE_UTILS_H
+#define __DEVICE_UTILS_H
+
+#include "../include/types_bikaya.h"
+
+void init_devTable(void);
+dev_desc_t* getDevDesc(memaddr dev_register, u_int subdevice);
+dev_desc_t* getLineDesc(u_int line, u_int dev_no, u_int recv);
+void dev_issue(dev_desc_t *desc, pcb_t *requester, u_int command);
+u_int dev_start_request(dev_desc_t *desc, pcb_t *requester, state_t *request);
+u_int dev_busy(dev_desc_t *desc);
+u_int dev_kernel_acquire(dev_desc_t *desc);
+void dev_kernel_release(dev_desc_t *desc);
+void dev_account(dev_desc_t *desc);
+void dev_abort(pcb_t *p);
+pcb_t* dev_complete(dev_desc_t *desc, u_int status);
+
+#endif
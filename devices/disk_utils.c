@@ -0,0 +1,530 @@
+#include "../include/system_const.h"
+#include "../include/types_bikaya.h"
+#include "../process/scheduler.h"
+#include "../generics/utils.h"
+#include "../generics/event_log.h"
+#include "../process/asl.h"
+#include "device_utils.h"
+#include "disk_utils.h"
+
+
+// Possible state of a cache slot
+#define SLOT_FREE      0
+#define SLOT_DIRTY     1
+#define SLOT_FLUSHING  2
+
+// Possible phase of the flush on a disk (the device is shared with WAITIO, the flush waits for its turn)
+#define FLUSH_IDLE     0
+#define FLUSH_WAIT     1
+#define FLUSH_SEEK     2
+#define FLUSH_WRITE    3
+
+// Head position after a failed seek, the cache will seek before writing
+#define HEAD_UNKNOWN   ((u_int) -1)
+
+
+// A cached block, the data buffer comes first so that is word aligned for the DMA
+typedef struct disk_slot_t {
+    unsigned char data[DISK_BLOCK_SIZE];
+    u_int state;
+    u_int disk_no;
+    u_int block;
+    u_int cyl, head, sect;
+    // Failed writes of the block, it's dropped after DISK_WRITE_RETRIES
+    u_int errors;
+} disk_slot_t;
+
+// Flush progress of a single disk
+typedef struct disk_flush_t {
+    u_int phase;
+    int slot;
+    // Cylinder on which the disk head is positioned (used for the elevator ordering)
+    u_int head_cyl;
+    // DMA address left in the register by the processes, restored after each write of the cache
+    memaddr data0;
+} disk_flush_t;
+
+
+HIDDEN disk_slot_t cache[DISK_CACHE_SLOTS];
+HIDDEN disk_flush_t flush_state[DEV_PER_INT];
+
+// Number of slots not yet written on the device (both dirty and flushing)
+HIDDEN u_int dirty_slots = 0;
+// Clock at wich the oldest dirty block has been written in the cache
+HIDDEN u_int dirty_since = 0;
+// True while a flush is in progress, new dirty blocks are flushed as well
+HIDDEN u_int flushing = FALSE;
+// Number of blocks that couldn't be written since the last sync
+HIDDEN u_int write_errors = 0;
+
+// Kernel semaphores, writers wait on the first for a free slot and sync callers on the second
+HIDDEN int slot_sem = 0;
+HIDDEN int sync_sem = 0;
+
+
+
+/*
+    Initialize all the cache slots as free and the disks as idle
+
+    return: void
+*/
+void init_diskCache(void) {
+    for (u_int i = 0; i < DISK_CACHE_SLOTS; i++)
+        cache[i].state = SLOT_FREE;
+
+    for (u_int i = 0; i < DEV_PER_INT; i++) {
+        flush_state[i].phase = FLUSH_IDLE;
+        flush_state[i].slot = -1;
+        flush_state[i].head_cyl = 0;
+        flush_state[i].data0 = 0;
+    }
+
+    dirty_slots = 0;
+    flushing = FALSE;
+    write_errors = 0;
+}
+
+
+/*
+    Copies the given block in the cache, if the same block is already dirty then the
+    two writes are merged in the same slot, else a free slot is used (if any).
+    Slots that are being flushed are never touched since the device could be reading them.
+
+    disk_no: the disk where the block has to be written
+    block: the linear block number on the disk
+    buffer: the data to be written (DISK_BLOCK_SIZE bytes)
+    return: TRUE if the block has been cached, FALSE if there's no free slot
+*/
+HIDDEN u_int cache_store(u_int disk_no, u_int block, void *buffer) {
+    disk_slot_t *free_slot = NULL;
+
+    for (u_int i = 0; i < DISK_CACHE_SLOTS; i++) {
+        disk_slot_t *slot = &cache[i];
+
+        // Repeated write on the same block, simply overwrite the previous one
+        if (slot->state == SLOT_DIRTY && slot->disk_no == disk_no && slot->block == block) {
+            copy_Memory(slot->data, buffer, DISK_BLOCK_SIZE);
+            return (TRUE);
+        }
+        else if (slot->state == SLOT_FREE && free_slot == NULL)
+            free_slot = slot;
+    }
+
+    if (free_slot == NULL)
+        return (FALSE);
+
+    // Translate the linear block number in the disk geometry
+    dtpreg_t *disk = (dtpreg_t*) DEV_REG_ADDR(IL_DISK, disk_no);
+    u_int max_head = DISK_MAXHEAD(disk->data1), max_sect = DISK_MAXSECT(disk->data1);
+
+    free_slot->disk_no = disk_no;
+    free_slot->block = block;
+    free_slot->sect = block % max_sect;
+    free_slot->head = (block / max_sect) % max_head;
+    free_slot->cyl = block / (max_sect * max_head);
+    free_slot->errors = 0;
+    copy_Memory(free_slot->data, buffer, DISK_BLOCK_SIZE);
+
+    free_slot->state = SLOT_DIRTY;
+    (dirty_slots++ == 0) ? (dirty_since = TOD_LO) : 0;
+
+    return (TRUE);
+}
+
+
+/*
+    Looks for the cached copy of a block, given its position on the disk. If the block has been
+    written again while the old copy was being flushed the dirty one is the newest.
+
+    disk_no: the disk of the block
+    cyl, head, sect: the position of the block
+    return: the slot with the newest copy of the block, NULL if it isn't in the cache
+*/
+HIDDEN disk_slot_t* cache_lookup(u_int disk_no, u_int cyl, u_int head, u_int sect) {
+    disk_slot_t *found = NULL;
+
+    for (u_int i = 0; i < DISK_CACHE_SLOTS; i++) {
+        disk_slot_t *slot = &cache[i];
+
+        if (slot->state == SLOT_FREE || slot->disk_no != disk_no || slot->cyl != cyl || slot->head != head || slot->sect != sect)
+            continue;
+
+        if (found == NULL || slot->state == SLOT_DIRTY)
+            found = slot;
+    }
+
+    return (found);
+}
+
+
+/*
+    Chooses the next block to write on the given disk with a C-SCAN policy,
+    the nearest dirty block from the head cylinder onward is taken first and
+    when there's none the head restarts from the lowest cylinder
+
+    disk_no: the disk to be served
+    return: the index of the chosen slot, -1 if there's no dirty block for the disk
+*/
+HIDDEN int elevator_next(u_int disk_no) {
+    u_int head_cyl = flush_state[disk_no].head_cyl;
+    int forward = -1, lowest = -1;
+
+    for (int i = 0; i < DISK_CACHE_SLOTS; i++) {
+        disk_slot_t *slot = &cache[i];
+
+        if (slot->state != SLOT_DIRTY || slot->disk_no != disk_no)
+            continue;
+
+        if (slot->cyl >= head_cyl && (forward < 0 || slot->cyl < cache[forward].cyl))
+            forward = i;
+        if (lowest < 0 || slot->cyl < cache[lowest].cyl)
+            lowest = i;
+    }
+
+    return ((forward >= 0) ? forward : lowest);
+}
+
+
+/*
+    Issues the write of the slot being flushed on the given disk, the head must already
+    be on the right cylinder. The DMA address in the register is saved, a process
+    could have set it before its WAITIO.
+
+    disk_no: the disk on wich the write has to be issued
+    return: void
+*/
+HIDDEN void issue_write(u_int disk_no) {
+    dev_desc_t *desc = getLineDesc(IL_DISK, disk_no, FALSE);
+    disk_slot_t *slot = &cache[flush_state[disk_no].slot];
+
+    flush_state[disk_no].phase = FLUSH_WRITE;
+    LOG_EVENT(EV_DISK_WRITE, disk_no, slot->block);
+    flush_state[disk_no].data0 = desc->reg->dtp.data0;
+    desc->reg->dtp.data0 = (memaddr) slot->data;
+    dev_issue(desc, NULL, (slot->head << DISK_HEAD_SHIFT) | (slot->sect << DISK_SECT_SHIFT) | DISK_WRITEBLK);
+}
+
+
+/*
+    Continues the flush of the given disk if there are dirty blocks left, else the disk goes
+    idle. The device is shared with the WAITIO requests so the cache must wait for its turn,
+    the write is then issued by disk_cache_resume.
+
+    disk_no: the disk to be flushed
+    return: void
+*/
+HIDDEN void flush_next(u_int disk_no) {
+    disk_flush_t *state = &flush_state[disk_no];
+
+    if (elevator_next(disk_no) < 0) {
+        state->phase = FLUSH_IDLE;
+        return ;
+    }
+
+    state->phase = FLUSH_WAIT;
+
+    if (dev_kernel_acquire(getLineDesc(IL_DISK, disk_no, FALSE)))
+        disk_cache_resume(disk_no);
+}
+
+
+// Starts the flush on every idle disk, the ones already flushing will continue on their own
+HIDDEN void start_flush(void) {
+    flushing = TRUE;
+
+    for (u_int i = 0; i < DEV_PER_INT; i++)
+        if (flush_state[i].phase == FLUSH_IDLE)
+            flush_next(i);
+}
+
+
+/*
+    Completes the pending writes of the processes blocked for a free slot, the
+    arguments are retrieved from the syscall registers saved in their state.
+    The waiters are served in FIFO order and stops at the first that doesn't fit.
+
+    return: void
+*/
+HIDDEN void serve_slot_waiters(void) {
+    pcb_t *waiting;
+
+    while ((waiting = headBlocked(&slot_sem)) != NULL) {
+        state_t *args = &waiting->p_s;
+
+        if (! cache_store(SYS_ARG_1(args), SYS_ARG_2(args), (void*)SYS_ARG_3(args)))
+            return ;
+
+        removeBlocked(&slot_sem);
+        SYS_RETURN_VAL(args) = SUCCESS;
+        scheduler_add(waiting);
+    }
+}
+
+
+/*
+    When the whole cache has been written back ends the flush and wakes up all the
+    processes waiting for the sync, returning them FAILURE if some block got lost
+
+    return: void
+*/
+HIDDEN void check_flush_done(void) {
+    pcb_t *waiting;
+
+    if (dirty_slots > 0)
+        return ;
+
+    flushing = FALSE;
+
+    while ((waiting = removeBlocked(&sync_sem)) != NULL) {
+        SYS_RETURN_VAL(((state_t*) &waiting->p_s)) = (write_errors) ? FAILURE : SUCCESS;
+        scheduler_add(waiting);
+    }
+
+    write_errors = 0;
+}
+
+
+/*
+    Accepts a block write on the given disk and returns without waiting for the device.
+    If the cache is full (or other writers are already waiting) a flush is started and the
+    caller must wait on the returned semaphore, the write will be completed by the cache.
+
+    disk_no: the disk where the block has to be written
+    block: the linear block number on the disk
+    buffer: the data to be written (DISK_BLOCK_SIZE bytes)
+    wait_sem: set to the semaphore on wich the caller has to wait if needed
+    return: SUCCESS if cached, FAILURE on invalid arguments, DISK_MUST_WAIT if the caller has to wait
+*/
+int disk_cache_write(u_int disk_no, u_int block, void *buffer, int **wait_sem) {
+    if (disk_no >= DEV_PER_INT || buffer == NULL)
+        return (FAILURE);
+
+    dtpreg_t *disk = (dtpreg_t*) DEV_REG_ADDR(IL_DISK, disk_no);
+    u_int geometry = disk->data1;
+    u_int disk_blocks = DISK_MAXCYL(geometry) * DISK_MAXHEAD(geometry) * DISK_MAXSECT(geometry);
+
+    if (DEV_STATUS_REG(disk) == DVC_NOT_INSTALLED || block >= disk_blocks)
+        return (FAILURE);
+
+    // The FIFO order of the waiters is kept, else a merged write could be overridden by an older one
+    if (headBlocked(&slot_sem) != NULL || ! cache_store(disk_no, block, buffer)) {
+        start_flush();
+        *wait_sem = &slot_sem;
+        return (DISK_MUST_WAIT);
+    }
+
+    // Memory pressure, or a flush is already running and the new block can be written as well
+    if (flushing || dirty_slots >= DISK_HIGH_WATERMARK)
+        start_flush();
+
+    return (SUCCESS);
+}
+
+
+/*
+    Forces the write back of all the dirty blocks in the cache. If the cache is
+    already clean returns immediately, else the caller must wait on the returned semaphore.
+
+    wait_sem: set to the semaphore on wich the caller has to wait if needed
+    return: SUCCESS or FAILURE (if a block got lost since the last sync), DISK_MUST_WAIT if the caller has to wait
+*/
+int disk_cache_sync(int **wait_sem) {
+    if (dirty_slots == 0) {
+        int result = (write_errors) ? FAILURE : SUCCESS;
+        write_errors = 0;
+        return (result);
+    }
+
+    start_flush();
+    *wait_sem = &sync_sem;
+    return (DISK_MUST_WAIT);
+}
+
+
+/*
+    Called on each interval timer interrupt, starts the flush if the oldest
+    dirty block has been waiting in memory for more than DISK_FLUSH_INTERVAL
+
+    current_clock: the clock at wich the call was made
+    return: void
+*/
+void disk_cache_tick(u_int current_clock) {
+    if (dirty_slots > 0 && ! flushing && (current_clock - dirty_since) >= DISK_FLUSH_INTERVAL)
+        start_flush();
+}
+
+
+/*
+    Returns the number of blocks not yet written on the devices, starting the flush
+    of them if any. Used before shutting off so that no data is lost.
+
+    return: the number of blocks still in memory
+*/
+u_int disk_cache_flush(void) {
+    if (dirty_slots > 0)
+        start_flush();
+
+    return (dirty_slots);
+}
+
+
+/*
+    Keeps the cache coherent with the requests made by the processes with WAITIO, called
+    before one is issued on a disk. A read of a block still in the cache is served with the
+    cached copy, while a write of a dirty block makes the cached copy obsolete (it's dropped).
+
+    disk_no: the disk of the request
+    command: the command of the request, the block is on the cylinder of the head
+    buffer: the DMA address of the request
+    return: TRUE if the request has been served by the cache, FALSE if it has to be issued
+*/
+u_int disk_cache_request(u_int disk_no, u_int command, memaddr buffer) {
+    u_int opcode = DISK_OPCODE(command);
+    u_int head = DISK_CMD_HEAD(command), sect = DISK_CMD_SECT(command);
+
+    if (opcode != DISK_READBLK && opcode != DISK_WRITEBLK)
+        return (FALSE);
+
+    disk_slot_t *slot = cache_lookup(disk_no, flush_state[disk_no].head_cyl, head, sect);
+
+    if (slot == NULL)
+        return (FALSE);
+
+    if (opcode == DISK_READBLK) {
+        copy_Memory((void*) buffer, slot->data, DISK_BLOCK_SIZE);
+        return (TRUE);
+    }
+
+    // The cache doesn't own the device, so no slot is being flushed
+    slot->state = SLOT_FREE;
+    dirty_slots--;
+    serve_slot_waiters();
+    check_flush_done();
+
+    return (FALSE);
+}
+
+
+/*
+    Records the new position of the head after a seek made by a process,
+    if the seek failed the head position is unknown
+
+    disk_no: the disk
+    cyl: the cylinder requested by the seek
+    status: the status of the completed seek
+    return: void
+*/
+void disk_cache_seek_done(u_int disk_no, u_int cyl, u_int status) {
+    flush_state[disk_no].head_cyl = ((status & DISK_STATUS_MASK) == DISK_READY) ? cyl : HEAD_UNKNOWN;
+}
+
+
+/*
+    Called when the cache owns the disk, issues the write of the next dirty block (in elevator
+    order) seeking the right cylinder before if needed. If no dirty block is left the device
+    is given back to the processes.
+
+    disk_no: the disk owned by the cache
+    return: void
+*/
+void disk_cache_resume(u_int disk_no) {
+    disk_flush_t *state = &flush_state[disk_no];
+    dev_desc_t *desc = getLineDesc(IL_DISK, disk_no, FALSE);
+    int next = elevator_next(disk_no);
+
+    // The dirty blocks could have been overwritten by the processes while waiting
+    if (next < 0) {
+        state->phase = FLUSH_IDLE;
+        state->slot = -1;
+        dev_kernel_release(desc);
+        return ;
+    }
+
+    cache[next].state = SLOT_FLUSHING;
+    state->slot = next;
+
+    if (cache[next].cyl == state->head_cyl)
+        issue_write(disk_no);
+
+    else {
+        state->phase = FLUSH_SEEK;
+        dev_issue(desc, NULL, (cache[next].cyl << DISK_CYL_SHIFT) | DISK_SEEKCYL);
+    }
+}
+
+
+/*
+    Handles a failed write back (or seek), the block stays dirty and is tried again
+    unless a newer copy is in the cache or it has already failed DISK_WRITE_RETRIES times
+
+    slot: the slot that couldn't be written
+    return: void
+*/
+HIDDEN void write_failed(disk_slot_t *slot) {
+    slot->state = SLOT_FREE;
+    u_int superseded = cache_lookup(slot->disk_no, slot->cyl, slot->head, slot->sect) != NULL;
+
+    if (++slot->errors < DISK_WRITE_RETRIES && ! superseded) {
+        slot->state = SLOT_DIRTY;
+        return ;
+    }
+
+    // The newer copy will be written instead, else the block is lost
+    if (! superseded)
+        write_errors++;
+    dirty_slots--;
+}
+
+
+/*
+    Handles the interrupt of a disk owned by the cache, the seek is followed by the write
+    and then the device is given back: the processes waiting for it go before the next
+    block. A block that couldn't be written is tried again (the head could be lost as well).
+
+    disk_no: the disk that raised the interrupt
+    return: TRUE if the interrupt belonged to the cache (and was acknowledged), FALSE else
+*/
+int disk_cache_interrupt(u_int disk_no) {
+    disk_flush_t *state = &flush_state[disk_no];
+    dev_desc_t *desc = getLineDesc(IL_DISK, disk_no, FALSE);
+    dtpreg_t *disk = &desc->reg->dtp;
+
+    // The device is shared with WAITIO, the completions of the process requests aren't handled here
+    if (! desc->kernel_owned)
+        return (FALSE);
+
+    disk_slot_t *slot = &cache[state->slot];
+    u_int status = DISK_STATUS(disk);
+    dev_account(desc);
+
+    // The seek was successfull, now the block can be written (the new command acks the interrupt)
+    if (state->phase == FLUSH_SEEK && status == DISK_READY) {
+        state->head_cyl = slot->cyl;
+        issue_write(disk_no);
+        return (TRUE);
+    }
+
+    disk->command = CMD_ACK;
+    // A process could have set its DMA address during the write, else the previous one is restored
+    if (state->phase == FLUSH_WRITE && disk->data0 == (memaddr) slot->data)
+        disk->data0 = state->data0;
+
+    if (status == DISK_READY) {
+        slot->state = SLOT_FREE;
+        dirty_slots--;
+    }
+    else {
+        state->head_cyl = HEAD_UNKNOWN;
+        write_failed(slot);
+    }
+
+    state->phase = FLUSH_IDLE;
+    state->slot = -1;
+    dev_kernel_release(desc);
+
+    serve_slot_waiters();
+    flush_next(disk_no);
+    check_flush_done();
+
+    return (TRUE);
+}
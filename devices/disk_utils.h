@@ -0,0 +1,54 @@
+#ifndef __DISK_UTILS_H
+#define __DISK_UTILS_H
+
+#include "../include/types_bikaya.h"
+
+// LIST OF THE POSSIBLE COMMAND INPUT TO dp->command (cylinder, head and sector are shifted in)
+#define DISK_SEEKCYL       2
+#define DISK_READBLK       3
+#define DISK_WRITEBLK      4
+
+#define DISK_CYL_SHIFT     8
+#define DISK_HEAD_SHIFT    16
+#define DISK_SECT_SHIFT    8
+
+// Fields of a command made by a process
+#define DISK_OPCODE(cmd)   ((cmd) & 0xFF)
+#define DISK_CMD_HEAD(cmd) (((cmd) >> DISK_HEAD_SHIFT) & 0xFF)
+#define DISK_CMD_SECT(cmd) (((cmd) >> DISK_SECT_SHIFT) & 0xFF)
+
+// Status of a disk (the register holds only the status code) and the one of a successful command
+#define DISK_STATUS_MASK   0xFF
+#define DISK_STATUS(dp)    ((dp)->status & DISK_STATUS_MASK)
+#define DISK_READY         1
+
+// Disk geometry, as exposed by the device in the data1 registrer
+#define DISK_MAXCYL(data1)  ((data1) >> 16)
+#define DISK_MAXHEAD(data1) (((data1) >> 8) & 0xFF)
+#define DISK_MAXSECT(data1) ((data1) & 0xFF)
+
+// Write-back cache sizing, a slot holds exactly one disk block
+#define DISK_BLOCK_SIZE    4096
+#define DISK_CACHE_SLOTS   8
+// Dirty slots after wich a flush is started without waiting for the timer
+#define DISK_HIGH_WATERMARK 6
+// Max time (in clocks) a dirty block can stay in memory before being flushed
+#define DISK_FLUSH_INTERVAL (100 * TIME_SLICE)
+
+// Writes of a block tried before it's dropped (the loss is then reported by the next sync)
+#define DISK_WRITE_RETRIES 3
+
+// Return code of the cache when the caller has to wait (cache full or sync pending)
+#define DISK_MUST_WAIT     1
+
+void init_diskCache(void);
+int disk_cache_write(u_int disk_no, u_int block, void *buffer, int **wait_sem);
+int disk_cache_sync(int **wait_sem);
+void disk_cache_tick(u_int current_clock);
+u_int disk_cache_flush(void);
+u_int disk_cache_request(u_int disk_no, u_int command, memaddr buffer);
+void disk_cache_seek_done(u_int disk_no, u_int cyl, u_int status);
+void disk_cache_resume(u_int disk_no);
+int disk_cache_interrupt(u_int disk_no);
+
+#endif
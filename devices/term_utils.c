@@ -1,8 +1,26 @@
 #include "../include/system_const.h"
 #include "../include/types_bikaya.h"
+#include "../process/scheduler.h"
+#include "../process/asl.h"
+#include "device_utils.h"
 #include "term_utils.h"
 
 
+// Kernel receive buffer of a terminal, a ring filled from the interrupt handler
+typedef struct term_rx_t {
+    char ring[TERM_RX_SIZE];
+    u_int head, count;
+    // Number of complete lines (newlines) in the ring
+    u_int lines;
+    // TRUE while a receive command is pending on the device
+    u_int armed;
+    // Semaphore on wich the readers wait for a line
+    int wait_sem;
+} term_rx_t;
+
+HIDDEN term_rx_t rx_buffer[DEV_PER_INT];
+
+
 
 // This function return the status of the terminal pointer given in input
 static unsigned int trans_status(termreg_t *tp) {
@@ -141,4 +159,143 @@ void term_gets(char usr_input[], u_int STR_LENGHT, u_int subdevice) {
 
     // Terminate the string with the 0, and return the readed string
     usr_input[i] = '\0';
-}
\ No newline at end of file
+}
+
+
+
+/* ================ KERNEL LINE BUFFER ================ */
+
+// Issues a new receive command on the terminal (it acks the previous interrupt as well)
+HIDDEN void rx_arm(u_int term_no) {
+    rx_buffer[term_no].armed = TRUE;
+    dev_issue(getLineDesc(IL_TERMINAL, term_no, TRUE), NULL, CMD_RECEIVE);
+}
+
+
+// Returns TRUE if a read of length bytes can be completed without waiting
+HIDDEN u_int rx_line_ready(term_rx_t *rx, u_int length) {
+    return (rx->lines > 0 || rx->count >= length - 1 || rx->count == TERM_RX_SIZE);
+}
+
+
+/*
+    Moves a line from the terminal ring to the buffer, stopping at the newline
+    (that is consumed but not copied) or when the buffer is full, and terminates
+    the string. If the receiver was stopped for the ring being full it's restarted.
+
+    term_no: the terminal to read from
+    buffer: the destination, at least length bytes long
+    length: the size of the destination (NULL terminator included)
+    return: the number of chars copied (NULL terminator excluded)
+*/
+HIDDEN int rx_take_line(u_int term_no, char *buffer, u_int length) {
+    term_rx_t *rx = &rx_buffer[term_no];
+    u_int copied = 0;
+
+    while (rx->count > 0 && copied < length - 1) {
+        char c = rx->ring[rx->head];
+        rx->head = (rx->head + 1) & (TERM_RX_SIZE - 1);
+        rx->count--;
+
+        if (c == '\n') {
+            rx->lines--;
+            break;
+        }
+        buffer[copied++] = c;
+    }
+
+    buffer[copied] = EOS;
+
+    if (! rx->armed)
+        rx_arm(term_no);
+
+    return (copied);
+}
+
+
+/*
+    Reads a line from the kernel buffer of the terminal. The first read on a terminal
+    reserves its receiver to the kernel, from then the chars are received by the interrupt
+    handler even with no reader. If a line isn't available yet the caller has to wait.
+    The receiver can't be reserved while it's used by WAITIO (the read fails).
+
+    buffer: the destination, at least length bytes long
+    length: the size of the destination (NULL terminator included)
+    term_no: the terminal to read from
+    wait_sem: set to the semaphore on wich the caller has to wait if needed
+    return: the number of chars read, -1 on failure
+*/
+int term_readline(char *buffer, u_int length, u_int term_no, int **wait_sem) {
+    if (term_no >= DEV_PER_INT || buffer == NULL || length == 0)
+        return (FAILURE);
+
+    dev_desc_t *desc = getLineDesc(IL_TERMINAL, term_no, TRUE);
+    term_rx_t *rx = &rx_buffer[term_no];
+
+    if (recv_status(&desc->reg->term) == TERM_N_INSTALLED)
+        return (FAILURE);
+
+    if (! desc->reserved) {
+        // A receive issued (or queued) with WAITIO would be overwritten
+        if (dev_busy(desc))
+            return (FAILURE);
+
+        desc->reserved = TRUE;
+        rx_arm(term_no);
+    }
+
+    // Preserves the FIFO order of the readers
+    if (headBlocked(&rx->wait_sem) != NULL || ! rx_line_ready(rx, length)) {
+        *wait_sem = &rx->wait_sem;
+        return (0);
+    }
+
+    return (rx_take_line(term_no, buffer, length));
+}
+
+
+/*
+    Handles the receive interrupt of a terminal reserved to the kernel, the char is
+    appended to the ring and the receiver restarted (unless the ring is full, the char
+    stays in the device till there's space). Then the readers with a complete line are
+    served in FIFO order, their arguments are retrieved from the saved syscall registers.
+
+    term_no: the terminal that raised the interrupt
+    status: the receive status read before the acknowledgement
+    return: TRUE if the terminal is reserved to the kernel (the interrupt is handled), FALSE else
+*/
+int term_rx_interrupt(u_int term_no, u_int status) {
+    dev_desc_t *desc = getLineDesc(IL_TERMINAL, term_no, TRUE);
+    term_rx_t *rx = &rx_buffer[term_no];
+    pcb_t *reader;
+
+    if (! desc->reserved)
+        return (FALSE);
+
+    dev_account(desc);
+    rx->armed = FALSE;
+
+    if ((status & TERM_STATUS_MASK) == ST_RECEIVED) {
+        char c = (status & DATA_MASK) >> CHAR_OFFSET;
+        rx->ring[(rx->head + rx->count) & (TERM_RX_SIZE - 1)] = c;
+        rx->count++;
+        (c == '\n') ? rx->lines++ : 0;
+    }
+
+    if (rx->count < TERM_RX_SIZE)
+        rx_arm(term_no);
+
+    while ((reader = headBlocked(&rx->wait_sem)) != NULL) {
+        state_t *args = &reader->p_s;
+
+        if (! rx_line_ready(rx, SYS_ARG_2(args)))
+            break;
+
+        removeBlocked(&rx->wait_sem);
+        // Return value from the ReadLine syscall
+        SYS_RETURN_VAL(args) = rx_take_line(term_no, (char*)SYS_ARG_1(args), SYS_ARG_2(args));
+        scheduler_add(reader);
+    }
+
+    return (TRUE);
+}
@@ -20,10 +20,17 @@
 #define CMD_RECEIVE        2       // They both impose to the terminal to make an operation (transmit/receive)
 
 #define CHAR_OFFSET        8       // The data transmitted/received are/shall be placed from (8 to 15 bit) used to shift
+#define TRANSMIT_CHAR(c)   ((((u_int)(c)) << CHAR_OFFSET) | CMD_TRANSMIT)
 #define TERM_STATUS_MASK   0xFF    // 0.0.0.11111111 => 255. Used to mask the first 12 bit (most significant one)
 #define DATA_MASK          0xFF00  // The mask to clean the data rcv'd => 0.0.11111111.0
 
+// Size of the kernel receive buffer of each terminal (must be a power of 2)
+#define TERM_RX_SIZE       128
+
 void term_puts(const char *str, unsigned int subdevice);
 void term_gets(char usr_input[], unsigned int STR_LENGHT, unsigned int subdevice);
 
+int term_readline(char *buffer, unsigned int length, unsigned int term_no, int **wait_sem);
+int term_rx_interrupt(unsigned int term_no, unsigned int status);
+
 #endif
\ No newline at end of file
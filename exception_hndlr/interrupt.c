@@ -1,9 +1,13 @@
 #include "../devices/interval_timer_utils.h"
+#include "../devices/disk_utils.h"
+#include "../devices/device_utils.h"
 #include "../include/system_const.h"
 #include "../process/scheduler.h"
 #include "../generics/utils.h"
+#include "../generics/event_log.h"
 #include "../process/pcb.h"
 #include "../process/asl.h"
+#include "../process/timer.h"
 #include "interrupt.h"
 
 
@@ -24,6 +28,8 @@ HIDDEN void unsupported_dev_handler(unsigned int line) {
 HIDDEN void intervalTimer_handler(unsigned int line) {
    // Send an Ack to the timer, sets him up to a timeslice
    setIntervalTimer();
+   // Dirty blocks in the disk cache are periodically written back
+   disk_cache_tick(TOD_LO);
 }
 
 
@@ -35,14 +41,18 @@ HIDDEN void generic_dev_handler(unsigned int line) {
    for (unsigned int subdev = 0; subdev < DEV_PER_INT; subdev++) {
       // If a device has a pending interrupt, get a reference to it
       if ((pending & (1 << subdev))) {
-         dtpreg_t *tmp_dev = (dtpreg_t*)DEV_REG_ADDR(line, subdev);
+         // The disk is owned by the cache, the interrupt was raised by a flush (already acknowledged)
+         if (line == IL_DISK && disk_cache_interrupt(subdev))
+            continue;
+
+         dev_desc_t *desc = getLineDesc(line, subdev, FALSE);
+         dtpreg_t *tmp_dev = &desc->reg->dtp;
          
          if (DEV_STATUS_REG(tmp_dev) != DVC_NOT_INSTALLED && DEV_STATUS_REG(tmp_dev) != DVC_BUSY ) {
-            pcb_t *unblocked = removeBlocked(&IO_blocked[EXT_IL_INDEX(line)][subdev]); 
-            scheduler_add(unblocked);
-            // Return value from the Wait_IO syscall
-            SYS_RETURN_VAL(((state_t*) &unblocked->p_s)) = DEV_STATUS_REG(tmp_dev);
+            // Ack before completing, the next queued request could issue a new command
+            u_int status = DEV_STATUS_REG(tmp_dev);
             tmp_dev->command = CMD_ACK;
+            dev_complete(desc, status);
          }
 
          else PANIC();
@@ -51,6 +61,9 @@ HIDDEN void generic_dev_handler(unsigned int line) {
 }
 
 
+// A terminal half has completed a command (successfully or not) if it's neither idle nor busy
+#define TERM_COMPLETED(status) ((status) != DVC_NOT_INSTALLED && (status) != DVC_BUSY && (status) != ST_READY)
+
 HIDDEN void terminal_handler(unsigned int line) {
    // Get the interrupt pending in terminal device
    unsigned int pending = *((memaddr*) CDEV_BITMAP_ADDR(line));
@@ -58,25 +71,31 @@ HIDDEN void terminal_handler(unsigned int line) {
    for (unsigned int subdev = 0; subdev < DEV_PER_INT; subdev++) {
       // If a device has a pending interrupt, get a reference to it
       if ((pending & (1 << subdev))) {
-         termreg_t *tmp_term = (termreg_t*)DEV_REG_ADDR(IL_TERMINAL, subdev);
-         
-        if (TRANSM_STATUS(tmp_term) != DVC_NOT_INSTALLED && TRANSM_STATUS(tmp_term) != DVC_BUSY ) {
-            pcb_t *unblocked = removeBlocked(&IO_blocked[EXT_IL_INDEX(line)][subdev]);
-            scheduler_add(unblocked);
-            // Return value from the Wait_IO syscall
-            SYS_RETURN_VAL(((state_t*) &unblocked->p_s)) = tmp_term->transm_status;
+         dev_desc_t *transm = getLineDesc(line, subdev, FALSE), *recv = getLineDesc(line, subdev, TRUE);
+         termreg_t *tmp_term = &transm->reg->term;
+         unsigned int served = FALSE;
+
+         // Both halves can have completed a command, an idle one (ready) has nothing to complete
+         if (TERM_COMPLETED(TRANSM_STATUS(tmp_term))) {
+            // Ack before completing, the next char of a string (or a queued request) is issued right away
+            u_int status = tmp_term->transm_status;
             tmp_term->transm_command = CMD_ACK;
+            dev_complete(transm, status);
+            served = TRUE;
          }
 
-         else if (RECV_STATUS(tmp_term) != DVC_NOT_INSTALLED && RECV_STATUS(tmp_term) != DVC_BUSY ) {
-            pcb_t *unblocked = removeBlocked(&IO_blocked[EXT_IL_INDEX(line) + 1][subdev]);
-            scheduler_add(unblocked);
-            // Return value from the Wait_IO syscall
-            SYS_RETURN_VAL(((state_t*) &unblocked->p_s)) = tmp_term->recv_status;
+         if (TERM_COMPLETED(RECV_STATUS(tmp_term))) {
+            u_int status = tmp_term->recv_status;
             tmp_term->recv_command = CMD_ACK;
+
+            // The terminal could be reserved for the kernel line buffer (READLINE)
+            if (! term_rx_interrupt(subdev, status))
+               dev_complete(recv, status);
+            served = TRUE;
          }
 
-         else PANIC();
+         if (! served)
+            PANIC();
       }
    }
    
@@ -137,19 +156,37 @@ void interrupt_handler(void) {
    // Check the exception code
    if (getExCode(old_area) != INTERRUPT_CODE)
       PANIC();
+
+   // The time slice left to the current process, read before the interval timer is reset
+   unsigned int quantum_left = getIntervalTimer();
    
    // Retrieve a vectorized version of the pending interrupt 
    unsigned int interruptVector[MAX_LINE];
    getInterruptLines(interruptVector);
 
    for (unsigned int line = 0; line < MAX_LINE; line++) 
-      if (interruptVector[line])
+      if (interruptVector[line]) {
+         LOG_EVENT(EV_INTERRUPT, line, getCurrentProc());
          subhandler[line](line);
+      }
+
+   // The timed waits whose deadline has passed are waken up with a timeout
+   timer_expire(TOD_LO);
+   // The real-time processes whose period has started are released
+   scheduler_release(TOD_LO);
 
    // Save the current old area state to the process that has executed
    pcb_t *currentProcess = getCurrentProc();
    currentProcess ? cloneState(&currentProcess->p_s, old_area, sizeof(state_t)) : 0;
+   // A preempted restartable sequence will start again from the beginning
+   if (currentProcess != NULL)
+      rseq_rollback(&currentProcess->p_s, currentProcess->p_rseq);
    update_time(KER_MD_TIME, TOD_LO);
-   // The scheduler will chose a process and reset a timeslice, else it will loop
-   scheduler();
+
+   // Only the end of the time slice requeues the current process (the scheduler will chose
+   // a process and reset a timeslice, else it will loop), after a device it goes on instead
+   if (interruptVector[IL_TIMER])
+      scheduler();
+   else
+      scheduler_resume(quantum_left);
 }
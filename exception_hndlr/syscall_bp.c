@@ -1,9 +1,15 @@
 #include "../include/system_const.h"
 #include "../include/types_bikaya.h"
 #include "../process/scheduler.h"
+#include "../devices/disk_utils.h"
+#include "../devices/device_utils.h"
 #include "../generics/utils.h"
+#include "../generics/event_log.h"
 #include "../process/asl.h"
 #include "../process/pcb.h"
+#include "../process/mutex.h"
+#include "../process/timer.h"
+#include "../process/group.h"
 #include "syscall_bp.h"
 
 
@@ -12,6 +18,47 @@ HIDDEN state_t *old_area = NULL;
 
 /* ================ SYSCALL DEFINITION ================ */
 
+/*
+    Blocks the current process (also the caller) on the given semaphore keys at once, saving
+    its state and time stats, then calls the scheduler to choose another process.
+    NOTE: this function never returns to the caller!
+
+    semkeys: the keys of the semaphores on wich the process has to wait
+    n: the number of semaphores
+    return: void
+*/
+HIDDEN void block_process_any(int *semkeys[], u_int n) {
+    // Get the current process PCB (with checks)
+    pcb_t *tmp = getCurrentProc();
+    (tmp == NULL) ? PANIC() : NULL;
+
+    // Saves the updated state adn time stats
+    cloneState(&tmp->p_s, old_area, sizeof(state_t));
+    update_time(KER_MD_TIME, TOD_LO);
+
+    // Insert the PCB in the semaphores blocked queues
+    (insertBlockedAny(semkeys, n, tmp)) ? PANIC() : NULL;
+    LOG_EVENT(EV_BLOCK, semkeys[0], tmp);
+
+    // Set the scheduler properly
+    setCurrentProc(NULL);
+    scheduler();
+}
+
+
+/*
+    Blocks the current process (also the caller) on the given semaphore key, as
+    block_process_any with a single semaphore.
+    NOTE: this function never returns to the caller!
+
+    semkey: the key of the semaphore on wich the process has to wait
+    return: void
+*/
+HIDDEN void block_process(int *semkey) {
+    block_process_any(&semkey, 1);
+}
+
+
 /*
     This syscall return the current process (also the caller process) time
     statistics such as usermode and kernel mode clock cycle elapsed as
@@ -59,9 +106,13 @@ HIDDEN void create_process(state_t* statep, int priority, void** cpid) {
     // Set the given state to the new process
     cloneState(&new_proc->p_s, statep, sizeof(state_t));
 
-    // Set priority and insert the PCB in the father's child node
+    // The child runs the same code of the parent, so it inherits its restartable sequences
+    copy_Memory(new_proc->p_rseq, parent->p_rseq, sizeof(rseq_t) * RSEQ_MAX);
+
+    // Set priority and insert the PCB in the father's child node (it's member of the same group)
     new_proc->priority = priority;
     insertChild(parent, new_proc);
+    group_join(new_proc, parent->p_group);
 
     // Insert the new process in the ready queue and sets the pid
     scheduler_add(new_proc);
@@ -76,6 +127,146 @@ HIDDEN void create_process(state_t* statep, int priority, void** cpid) {
 }
 
 
+// A process waiting on several semaphores (SEMWAITANY) gets the index of the one that waked it up
+HIDDEN void set_wait_index(pcb_t *p) {
+    if (p->p_syscall == SEMWAITANY)
+        SYS_RETURN_VAL(((state_t*) &p->p_s)) = p->p_waitindex;
+}
+
+
+/*
+    Wakes up all the processes blocked on the semaphore with a single kernel entry, they
+    are moved from the semaphore queue to the ready queue as a batch (keeping the order
+    of the semaphore queue among the ones with the same priority)
+
+    semaddr: the key of the semaphore
+    return: the number of processes waken up
+*/
+HIDDEN u_int wake_all(int *semaddr) {
+    LIST_HEAD(woken);
+    struct list_head *pos;
+    u_int n = removeAllBlocked(semaddr, &woken);
+
+    list_for_each(pos, &woken)
+        set_wait_index(container_of(pos, pcb_t, p_next));
+
+    scheduler_add_all(&woken);
+    return (n);
+}
+
+
+/*
+    Releases the semaphore n times, as many consecutive verhogen: for each unit the
+    first blocked process is waken up if there's one, else the value is incremented.
+    A mutex held by another process isn't released.
+
+    semaddr: the key/value of the semaphore to be released
+    n: the number of units released
+    caller: the process that releases the semaphore
+    return: the last process waken up, NULL if none
+*/
+HIDDEN pcb_t* sem_release(int *semaddr, u_int n, pcb_t *caller) {
+    pcb_t *last_unblocked = NULL;
+
+    // A mutex is handed off to the waken up process
+    while (n-- && mutex_release(semaddr, caller)) {
+        pcb_t *unblocked_proc = (*semaddr <= 0) ? removeBlocked(semaddr) : NULL;
+
+        if (unblocked_proc != NULL) {
+            mutex_acquire(semaddr, unblocked_proc);
+            set_wait_index(unblocked_proc);
+            scheduler_add(unblocked_proc);
+            last_unblocked = unblocked_proc;
+        }
+        else
+            *semaddr += 1;
+    }
+
+    return (last_unblocked);
+}
+
+
+/*
+    Returns the slot of the PCB where a reader-writer lock held by the process is
+    recorded (or a free slot, with lock NULL)
+
+    p: the process
+    lock: the reader-writer lock, NULL for a free slot
+    return: the index of the slot, -1 if not found
+*/
+HIDDEN int rw_slot(pcb_t *p, rwlock_t *lock) {
+    for (int i = 0; i < RWLOCK_MAX; i++)
+        if (p->p_rwlocks[i] == lock)
+            return (i);
+
+    return (-1);
+}
+
+// Records in the PCB a reader-writer lock just granted (a free slot has been checked before)
+HIDDEN void rw_hold(pcb_t *p, rwlock_t *lock, u_int writer) {
+    int slot = rw_slot(p, NULL);
+
+    p->p_rwlocks[slot] = lock;
+    p->p_rwwriter[slot] = writer;
+}
+
+
+/*
+    Hands a free reader-writer lock to the waiting processes: all the waiting readers
+    at once (in a single pass) or the first waiting writer. The admission is phase-fair:
+    after a writer the readers are preferred and after the readers a writer, so that
+    neither of them can be starved. The new holders are recorded in their PCBs.
+
+    lock: the reader-writer lock
+    prefer_readers: TRUE if the lock has been released by a writer
+    return: void
+*/
+HIDDEN void rw_grant(rwlock_t *lock, u_int prefer_readers) {
+    u_int readers_waiting = (headBlocked(&lock->read_queue) != NULL);
+    u_int writers_waiting = (headBlocked(&lock->write_queue) != NULL);
+
+    if (lock->writer || lock->readers > 0)
+        return ;
+
+    if (readers_waiting && (prefer_readers || ! writers_waiting)) {
+        LIST_HEAD(readers);
+        struct list_head *pos;
+
+        lock->readers += removeAllBlocked(&lock->read_queue, &readers);
+        list_for_each(pos, &readers)
+            rw_hold(container_of(pos, pcb_t, p_next), lock, FALSE);
+
+        scheduler_add_all(&readers);
+    }
+
+    else if (writers_waiting) {
+        pcb_t *writer = removeBlocked(&lock->write_queue);
+
+        lock->writer = TRUE;
+        rw_hold(writer, lock, TRUE);
+        scheduler_add(writer);
+    }
+}
+
+
+/*
+    Releases a reader-writer lock held by a process, handing it to the waiting ones
+    if it's free now
+
+    p: the process that holds the lock
+    slot: the slot of the PCB where the lock is recorded
+    return: void
+*/
+HIDDEN void rw_release(pcb_t *p, int slot) {
+    rwlock_t *lock = p->p_rwlocks[slot];
+    u_int writer = p->p_rwwriter[slot];
+
+    p->p_rwlocks[slot] = NULL;
+    writer ? (lock->writer = FALSE) : (lock->readers -= 1);
+    rw_grant(lock, writer);
+}
+
+
 /*
     This syscall terminates the process given as input (pid), removing recursively
     from the ASL, the ready queue and the father's child list.
@@ -97,6 +288,7 @@ void terminate_process(void* pid) {
     
     // Get all the descendants in a vector
     populate_PCB_tree(dynasty_vector, MAXPROC);
+    LOG_EVENT(EV_TERMINATE, dynasty_vector[0], getCurrentProc());
 
     for (u_int i = 0; i < MAXPROC && dynasty_vector[i] != NULL; i++) {
         pcb_t *proc = dynasty_vector[i];
@@ -106,9 +298,19 @@ void terminate_process(void* pid) {
         
         // Removes it from the sem queue if present
         outBlocked(proc);
+        // A device could still be executing its request (a string could be in transmission)
+        dev_abort(proc);
         
         // Removes it from the ready queue if present 
-        outProcQ(getReadyQ(), proc);
+        scheduler_remove(proc);
+
+        // Releases the mutexes it owns, else their waiters would be blocked forever
+        for (int *key = getOwnedSem(proc); key != NULL; key = getOwnedSem(proc))
+            sem_release(key, 1, proc);
+        // and the reader-writer locks it holds
+        for (int slot = 0; slot < RWLOCK_MAX; slot++)
+            if (proc->p_rwlocks[slot] != NULL)
+                rw_release(proc, slot);
         
         // Dealloc the PCB 
         freePcb(proc);
@@ -127,22 +329,32 @@ void terminate_process(void* pid) {
     This syscall releases the semaphore wich is identified with the semaddr arg.
     if other processes are waiting on the same semaphore then before leaving it
     awakes the first in the sem's queue. 
+    If the semaphore is in handoff mode (SEMCTL) and the waken up process goes before the
+    caller for the scheduling class (as when it preempts it), the caller is saved and the
+    other one executes right away.
+    A semaphore in mutex mode can be released only by the process that holds it.
     NOTE: the scheduler is preemptive but must be called manually!
 
     semaddr: the memory location/ value of the semaphore that has to be released
-    return: the unblocked process (for internal use only)
+    return: 0 on success, -1 if the semaphore is a mutex held by another process
 */
 HIDDEN void verhogen(int *semaddr) {
-    if (*semaddr <= 0) {
-        pcb_t *unblocked_proc = removeBlocked(semaddr);
+    pcb_t *caller = getCurrentProc();
 
-        if (unblocked_proc != NULL) {
-            scheduler_add(unblocked_proc);
-            return ;
-        }
+    if (! mutex_can_release(semaddr, caller)) {
+        SYS_RETURN_VAL(old_area) = FAILURE;
+        return ;
     }
 
-    *semaddr += 1;;
+    pcb_t *unblocked_proc = sem_release(semaddr, 1, caller);
+    SYS_RETURN_VAL(old_area) = SUCCESS;
+    semattr_t *attr = (unblocked_proc != NULL) ? getSemAttr(semaddr, FALSE) : NULL;
+
+    if (attr != NULL && (attr->flags & SEMATTR_HANDOFF) && scheduler_preempts(unblocked_proc)) {
+        cloneState(&caller->p_s, old_area, sizeof(state_t));
+        update_time(KER_MD_TIME, TOD_LO);
+        scheduler_handoff(unblocked_proc);
+    }
 }
 
 
@@ -157,59 +369,344 @@ HIDDEN void verhogen(int *semaddr) {
 */
 HIDDEN void passeren(int *semaddr) {
     if (*semaddr <= 0) {
-        // Get the current process PCB (with checks)
-        pcb_t *tmp = getCurrentProc();
-        (tmp == NULL) ? PANIC() : NULL;
+        // The owner of a mutex inherits the priority of the caller while it waits
+        mutex_wait(semaddr, getCurrentProc());
+        block_process(semaddr);
+    }
 
-        // Saves the updated state adn time stats
-        cloneState(&tmp->p_s, old_area, sizeof(state_t));
-        update_time(KER_MD_TIME, TOD_LO);
+    *semaddr -= 1;
+    mutex_acquire(semaddr, getCurrentProc());
+}
 
-        // Insert the PCB in the semaphor blocked queue
-        (insertBlocked(semaddr, tmp)) ? PANIC() : NULL;
 
-        // Set the scheduler properly
-        setCurrentProc(NULL);
-        scheduler();
+/*
+    This syscall requests a semaphore as passeren, but the caller waits for it at most
+    timeout clocks: if the deadline expires the process is removed from the semaphore
+    queue and waken up with TIMEOUT (the deadline is checked on every interrupt, so at
+    least once each time slice).
+
+    semaddr: the memory location/ value of the semaphore that has to be requested
+    timeout: the max time to wait (in clocks), 0 to return right away if not available
+    return: 0 when the semaphore is taken, -2 if the timeout expired
+*/
+HIDDEN void passeren_timed(int *semaddr, u_int timeout) {
+    pcb_t *caller = getCurrentProc();
+
+    if (*semaddr > 0) {
+        *semaddr -= 1;
+        mutex_acquire(semaddr, caller);
+        SYS_RETURN_VAL(old_area) = SUCCESS;
+        return ;
     }
 
-    *semaddr -= 1;
+    if (timeout == 0) {
+        SYS_RETURN_VAL(old_area) = TIMEOUT;
+        return ;
+    }
+
+    // Returned if waken up by a V, the timer expiration overwrites it
+    SYS_RETURN_VAL(old_area) = SUCCESS;
+    mutex_wait(semaddr, caller);
+    timer_add(caller, TOD_LO + timeout);
+    block_process(semaddr);
 }
 
 
 /*
-    This syscall retrieves the correct device structure from the dev_register memory location,
-    after it has determinated device_class and subdevice then the command argument is issued in 
-    the correct register in case the caller wants to issue a command to a terminal then must
-    provide a subdevice argument. After the command is issued the caller process is blocked on
-    a specific device semaphore, waiting to be waken up after the operation is completed.
+    This syscall requests one among several semaphores, the first that becomes available.
+    If one is already available it's taken right away (the one with the lowest index), else
+    the caller is blocked on all of them at once and waken up by the first V, that hands off
+    its semaphore: the process is then removed from the queues of the others.
+
+    semaddrs: the memory locations/ values of the semaphores
+    n: the number of semaphores (SEMWAIT_MAX at most)
+    return: the index of the semaphore taken on success, -1 on failure
+*/
+HIDDEN void passeren_any(int *semaddrs[], u_int n) {
+    u_int valid = (semaddrs != NULL && n > 0 && n <= SEMWAIT_MAX);
+
+    for (u_int i = 0; valid && i < n; i++)
+        valid = (semaddrs[i] != NULL);
+
+    if (! valid) {
+        SYS_RETURN_VAL(old_area) = FAILURE;
+        return ;
+    }
+
+    for (u_int i = 0; i < n; i++)
+        if (*semaddrs[i] > 0) {
+            *semaddrs[i] -= 1;
+            mutex_acquire(semaddrs[i], getCurrentProc());
+            SYS_RETURN_VAL(old_area) = i;
+            return ;
+        }
+
+    for (u_int i = 0; i < n; i++)
+        mutex_wait(semaddrs[i], getCurrentProc());
+
+    // NOTE: the return value is set by the V, the syscall number is needed to recognize the wait
+    block_process_any(semaddrs, n);
+}
+
+
+/*
+    This syscall waits on a barrier: the caller is blocked until parties processes
+    (the caller included) have arrived, then the last one opens the barrier waking
+    up all the others at once, and the barrier is ready to be used again. A waiter
+    terminated before the opening doesn't count as arrived.
+
+    barrier: the barrier, with parties set and arrived initialized to 0
+    return: 1 for the last process arrived, 0 for the others, -1 on failure
+*/
+HIDDEN void barrier_wait(barrier_t *barrier) {
+    if (barrier == NULL || barrier->parties <= 0) {
+        SYS_RETURN_VAL(old_area) = FAILURE;
+        return ;
+    }
+
+    // Counted on the queue, so a waiter that has been killed isn't counted anymore
+    barrier->arrived = countBlocked(&barrier->arrived) + 1;
+
+    if (barrier->arrived < barrier->parties) {
+        SYS_RETURN_VAL(old_area) = 0;
+        block_process(&barrier->arrived);
+    }
+
+    barrier->arrived = 0;
+    wake_all(&barrier->arrived);
+    SYS_RETURN_VAL(old_area) = 1;
+}
+
+
+/*
+    This syscall wakes up all the processes blocked on a semaphore with a single trap,
+    as many V as the waiters: each one takes a unit handed off, so the value doesn't change.
+    NOTE: the ownership of a mutex isn't handed off, don't use it on mutexes!
+
+    semaddr: the memory location/ value of the semaphore
+    return: the number of processes waken up, -1 on failure
+*/
+HIDDEN void sem_broadcast(int *semaddr) {
+    SYS_RETURN_VAL(old_area) = (semaddr != NULL) ? wake_all(semaddr) : (u_int) FAILURE;
+}
+
+
+/*
+    This syscall operates on a reader-writer lock, that can be held by many readers or by
+    a single writer. A new reader waits if a writer holds the lock or is waiting for it, so
+    the writers can't be starved, while the readers waiting when a writer releases the lock
+    are admitted all together before the next writer. The holders are recorded in their
+    PCBs: only a holder can unlock, and a process killed while holding the lock releases it.
+
+    lock: the reader-writer lock
+    op: RW_READ_LOCK, RW_READ_UNLOCK, RW_WRITE_LOCK or RW_WRITE_UNLOCK
+    return: 0 on success, -1 on failure (unknown operation, lock already held by the caller
+            or RWLOCK_MAX locks held, unlock of a lock not held by the caller in that mode)
+*/
+HIDDEN void rw_lock(rwlock_t *lock, u_int op) {
+    pcb_t *caller = getCurrentProc();
+    u_int is_free = (lock != NULL && ! lock->writer && lock->readers == 0);
+    int slot = (lock != NULL) ? rw_slot(caller, lock) : -1;
+    SYS_RETURN_VAL(old_area) = FAILURE;
+
+    if (lock == NULL)
+        return ;
+
+    switch (op) {
+        case RW_READ_LOCK:
+        case RW_WRITE_LOCK:
+            // The slot is kept free while the caller waits, the lock is recorded when granted
+            if (slot >= 0 || rw_slot(caller, NULL) < 0)
+                return ;
+
+            SYS_RETURN_VAL(old_area) = SUCCESS;
+
+            if (op == RW_READ_LOCK && (lock->writer || headBlocked(&lock->write_queue) != NULL))
+                block_process(&lock->read_queue);
+            else if (op == RW_WRITE_LOCK && ! is_free)
+                block_process(&lock->write_queue);
+
+            (op == RW_READ_LOCK) ? (lock->readers += 1) : (lock->writer = TRUE);
+            rw_hold(caller, lock, (op == RW_WRITE_LOCK));
+            break;
+
+        case RW_READ_UNLOCK:
+        case RW_WRITE_UNLOCK:
+            if (slot < 0 || caller->p_rwwriter[slot] != (op == RW_WRITE_UNLOCK))
+                return ;
+
+            SYS_RETURN_VAL(old_area) = SUCCESS;
+            rw_release(caller, slot);
+            break;
+    }
+}
+
+
+/*
+    This syscall applies in order an array of operations on semaphores, with a single trap.
+    A V(n) wakes up to n blocked processes, a P(n) takes n units one at time and blocks
+    on the first one not available: the syscall is then restarted from that operation when
+    the caller is waken up, with the unit handed off by the V already counted as taken.
+    The restart point is kept in the PCB, the registers of the caller aren't touched.
+    The operations before the blocking one stay applied (no rollback is done).
+    The whole array is checked when the syscall starts, so a restart never fails: a V
+    on a mutex taken by another process in the meantime isn't applied, as any V by a
+    process that doesn't hold the mutex. The array mustn't change while the caller waits.
+
+    ops: the operations to be applied (SEMOP_MAX at most)
+    n: the number of operations
+    return: 0 on success, -1 on failure (no operation is applied), also if a V would release a mutex held by another process
+*/
+HIDDEN void sem_op(semop_t *ops, u_int n) {
+    pcb_t *caller = getCurrentProc();
+    u_int granted = caller->p_semop_granted;
+    u_int restarted = (caller->p_semop != NULL);
+
+    if (restarted) {
+        ops = caller->p_semop;
+        n = caller->p_semop_left;
+    }
+    caller->p_semop = NULL;
+    caller->p_semop_granted = 0;
+
+    // A restarted SEMOP has already been checked, and some of its operations applied
+    u_int valid = restarted || (ops != NULL && n <= SEMOP_MAX);
+
+    // A V can't release a mutex held by another process
+    for (u_int i = 0; ! restarted && valid && i < n; i++)
+        valid = (ops[i].semaddr != NULL && (ops[i].delta <= 0 || mutex_can_release(ops[i].semaddr, caller)));
+
+    if (! valid) {
+        SYS_RETURN_VAL(old_area) = FAILURE;
+        return ;
+    }
+
+    for (u_int i = 0; i < n; i++, granted = 0) {
+        int *semaddr = ops[i].semaddr;
+
+        if (ops[i].delta > 0) {
+            sem_release(semaddr, ops[i].delta, caller);
+            continue;
+        }
+
+        for (; granted < (u_int) -ops[i].delta; granted++) {
+            if (*semaddr <= 0) {
+                // When waken the process executes again the syscall from this operation
+                caller->p_semop = &ops[i];
+                caller->p_semop_left = n - i;
+                caller->p_semop_granted = granted + 1;
+                PC_REG(old_area) -= WORDSIZE;
+                mutex_wait(semaddr, getCurrentProc());
+                block_process(semaddr);
+            }
+
+            *semaddr -= 1;
+            mutex_acquire(semaddr, getCurrentProc());
+        }
+    }
+
+    SYS_RETURN_VAL(old_area) = SUCCESS;
+}
+
+
+/*
+    This syscall sets the attributes of a semaphore, the available commands are:
+    SEM_MUTEX turns on (arg TRUE) or off (arg FALSE) the mutex mode, in wich the process
+    that holds the semaphore inherits the priority of the processes waiting for it.
+    SEM_WAKEPOLICY sets the order in wich the blocked processes are waken up, arg is
+    SEM_WAKE_FIFO (the default) or SEM_WAKE_PRIORITY (highest priority first).
+    SEM_HANDOFF turns on (arg TRUE) or off (arg FALSE) the handoff mode, in wich a V
+    switches straight to the waken up process if it has a higher priority than the caller.
+
+    cmd: the attribute to be set
+    semaddr: the key of the semaphore
+    arg: the value of the attribute
+    return: 0 on success, -1 on failure
+*/
+HIDDEN void sem_ctl(u_int cmd, int *semaddr, u_int arg) {
+    if (semaddr == NULL) {
+        SYS_RETURN_VAL(old_area) = FAILURE;
+        return ;
+    }
+
+    switch (cmd) {
+        case SEM_MUTEX:
+            SYS_RETURN_VAL(old_area) = mutex_mode(semaddr, arg);
+            break;
+
+        case SEM_WAKEPOLICY:
+            SYS_RETURN_VAL(old_area) = setWakePolicy(semaddr, arg);
+            break;
+
+        case SEM_HANDOFF:
+            SYS_RETURN_VAL(old_area) = setSemFlag(semaddr, SEMATTR_HANDOFF, arg);
+            break;
+
+        default:
+            SYS_RETURN_VAL(old_area) = FAILURE;
+    }
+}
+
+
+/*
+    This syscall retrieves the device descriptor from the dev_register memory location,
+    then the command argument is issued in the correct register, in case the caller wants to
+    issue a command to a terminal then must provide a subdevice argument. After the command 
+    is issued the caller process is blocked on the descriptor semaphore, waiting to be waken
+    up after the operation is completed.
 
     command: the command to be issued
     dev_register: the register in wich the command must be issued
     subdevice: arg for termina subdevice discrimination, 1 for recv, 0 for transm
-    return: void 
+    return: the device status on success, -1 if dev_register isn't a device register (or is reserved)
 */
 HIDDEN void wait_IO(u_int command, memaddr *dev_register, int subdevice) {
-    // Retrieve the first address of the multiple_line_device
-    memaddr dev_start = (memaddr)DEV_REG_ADDR(IL_DISK, 0);
-    memaddr current_memaddr = (memaddr)dev_register;
+    dev_desc_t *desc = getDevDesc((memaddr)dev_register, subdevice);
 
-    // Checks arguments and calculate the offset in words
-    (current_memaddr >= dev_start) ? 0 : PANIC();
-    u_int offset = current_memaddr - dev_start;
+    if (desc == NULL || desc->reserved) {
+        SYS_RETURN_VAL(old_area) = FAILURE;
+        return ;
+    }
+
+    // If the device is in use the request will be started when is its turn
+    if (dev_busy(desc))
+        block_process(&desc->queue_sem);
 
-    // From the word offset then is easy to obtain device class and subdevice
-    u_int device_class = offset / (DEV_REGISTER_SIZE * REGISTER_PER_DEV * DEV_PER_INT);
-    u_int device_no = offset % (DEV_REGISTER_SIZE * REGISTER_PER_DEV * DEV_PER_INT);
+    // Issue the command and block the process onto the device queue (unless the disk cache served it)
+    if (dev_start_request(desc, getCurrentProc(), old_area))
+        block_process(&desc->wait_sem);
+}
 
-    // Issue the command after it has determined the right register
-    devreg_t *device_p = (devreg_t *)dev_register;
-    (device_class < EXT_IL_INDEX(IL_TERMINAL)) ? device_p->dtp.command = command :
-        (subdevice) ? (device_p->term.recv_command = command) : (device_p->term.transm_command = command);
 
-    // Block the process onto the queue
-    int *matrix_cell = &IO_blocked[device_class + subdevice][device_no];
-    passeren(matrix_cell);
+/*
+    This syscall transmits a whole string on a terminal with a single trap, the chars are
+    sent one after the other from the terminal interrupt handler and the caller is waken up 
+    once, after the last one. If the terminal is in use the caller waits for its turn.
+
+    str: the chars to be transmitted (not necessarily NULL terminated)
+    length: the number of chars to be transmitted
+    term_no: the terminal on wich the string has to be transmitted
+    return: the number of chars transmitted on success, -1 on failure
+*/
+HIDDEN void term_write(char *str, u_int length, u_int term_no) {
+    dev_desc_t *desc = (term_no < DEV_PER_INT) ? getLineDesc(IL_TERMINAL, term_no, FALSE) : NULL;
+
+    if (desc == NULL || str == NULL || TRANSM_STATUS((&desc->reg->term)) == DVC_NOT_INSTALLED) {
+        SYS_RETURN_VAL(old_area) = FAILURE;
+        return ;
+    }
+
+    if (length == 0) {
+        SYS_RETURN_VAL(old_area) = 0;
+        return ;
+    }
+
+    if (dev_busy(desc))
+        block_process(&desc->queue_sem);
+
+    // The request is retrieved from the syscall registers, as for the queued ones
+    dev_start_request(desc, getCurrentProc(), old_area);
+    block_process(&desc->wait_sem);
 }
 
 
@@ -262,6 +759,345 @@ HIDDEN void get_PID_PPID(void** pid, void** ppid){
 
 
 
+/*
+    This syscall writes a block on a disk through the write-back cache, the block
+    is copied in kernel memory and the caller continues without waiting for the device.
+    Only if the cache is full the caller is blocked until a slot has been freed.
+
+    disk_no: the disk where the block has to be written
+    block: the linear block number on the disk
+    buffer: the DISK_BLOCK_SIZE bytes to be written
+    return: 0 on success, -1 on failure
+*/
+HIDDEN void disk_write(u_int disk_no, u_int block, void *buffer) {
+    int *wait_sem = NULL;
+    SYS_RETURN_VAL(old_area) = disk_cache_write(disk_no, block, buffer, &wait_sem);
+
+    // The write will be completed by the cache itself when a slot is freed
+    if (wait_sem != NULL)
+        block_process(wait_sem);
+}
+
+
+/*
+    This syscall forces the write back of all the dirty blocks in the cache,
+    the caller is blocked until all of them have been written on the devices
+
+    return: 0 on success, -1 if a block couldn't be written since the last sync
+*/
+HIDDEN void disk_sync(void) {
+    int *wait_sem = NULL;
+    SYS_RETURN_VAL(old_area) = disk_cache_sync(&wait_sem);
+
+    if (wait_sem != NULL)
+        block_process(wait_sem);
+}
+
+
+
+/*
+    This syscall reads a line from a terminal through the kernel line buffer, filled by the
+    interrupt handler, so the caller is blocked (using no CPU) only until a newline has been 
+    received or the buffer can be filled. The newline isn't copied and the string is NULL terminated.
+
+    buffer: the memory location where the line is copied
+    length: the size of the buffer (NULL terminator included)
+    term_no: the terminal to read from
+    return: the number of chars read on success, -1 on failure (or if the receiver is in use with WAITIO)
+*/
+HIDDEN void read_line(char *buffer, u_int length, u_int term_no) {
+    int *wait_sem = NULL;
+    SYS_RETURN_VAL(old_area) = term_readline(buffer, length, term_no, &wait_sem);
+
+    // The line will be copied by the interrupt handler once complete
+    if (wait_sem != NULL)
+        block_process(wait_sem);
+}
+
+
+/*
+    This syscall sets the disk area where the kernel event log is drained, the log
+    is written through the disk cache a block at time as soon as a block is complete
+
+    disk_no: the disk where the log is written, a negative value disables the drain
+    first_block: the first block of the area (used circularly)
+    blocks: the number of blocks of the area
+    return: 0 on success, -1 on failure (or if the event log is compiled out)
+*/
+HIDDEN void evlog_set_drain(int disk_no, u_int first_block, u_int blocks) {
+    SYS_RETURN_VAL(old_area) = evlog_drain(disk_no, first_block, blocks);
+}
+
+
+/*
+    This syscall copies the utilisation stats of the device that owns the given register
+    (number of operations, bytes transferred and busy time) in the stats argument
+
+    dev_register: the register of the device
+    subdevice: arg for termina subdevice discrimination, 1 for recv, 0 for transm
+    stats: the memory location where the stats are copied
+    return: 0 on success, -1 on failure
+*/
+HIDDEN void get_dev_stats(memaddr *dev_register, int subdevice, dev_stats_t *stats) {
+    dev_desc_t *desc = getDevDesc((memaddr)dev_register, subdevice);
+
+    if (desc == NULL || stats == NULL) {
+        SYS_RETURN_VAL(old_area) = FAILURE;
+        return ;
+    }
+
+    copy_Memory(stats, &desc->stats, sizeof(dev_stats_t));
+    SYS_RETURN_VAL(old_area) = SUCCESS;
+}
+
+
+
+/*
+    This syscall registers a restartable sequence for the caller, a range of code that
+    is executed again from the beginning if the process is preempted inside it.
+    The sequence must commit its effects with its last instruction.
+
+    start: the address of the first instruction of the sequence
+    end: the address following the last instruction of the sequence
+    return: 0 on success, -1 on failure (empty range or no free sequences)
+*/
+HIDDEN void rseq_register(memaddr start, memaddr end) {
+    rseq_t *rseq = getCurrentProc()->p_rseq;
+    SYS_RETURN_VAL(old_area) = FAILURE;
+
+    if (start >= end)
+        return ;
+
+    for (u_int i = 0; i < RSEQ_MAX; i++)
+        // A free slot has an empty range
+        if (rseq[i].start >= rseq[i].end) {
+            rseq[i].start = start;
+            rseq[i].end = end;
+            SYS_RETURN_VAL(old_area) = SUCCESS;
+            return ;
+        }
+}
+
+
+/*
+    This syscall is the slow path of the P on a user semaphore, called when the fast
+    path found the value not positive. The caller is counted in the waiters (so that
+    the fast path of the V traps) and blocked on the semaphore value.
+
+    sem: the user semaphore to be requested
+    return: void
+*/
+HIDDEN void usem_passeren(usem_t *sem) {
+    // The semaphore could have been released after the fast path failed
+    if (sem->value > 0) {
+        sem->value -= 1;
+        return ;
+    }
+
+    sem->waiters += 1;
+    block_process(&sem->value);
+}
+
+
+/*
+    This syscall is the slow path of the V on a user semaphore, called when the fast
+    path found waiters. The first one is waken up and the value is left unchanged.
+
+    sem: the user semaphore to be released
+    return: void
+*/
+HIDDEN void usem_verhogen(usem_t *sem) {
+    pcb_t *unblocked_proc = removeBlocked(&sem->value);
+
+    if (unblocked_proc != NULL) {
+        sem->waiters -= 1;
+        scheduler_add(unblocked_proc);
+        return ;
+    }
+
+    // The waiters have been killed while blocked, nobody is left
+    sem->waiters = 0;
+    sem->value += 1;
+}
+
+
+
+/*
+    This syscall copies the contention stats of the most contended semaphores (the ones
+    with the highest total wait time): number of blocked P, total and max wait time and
+    max queue length. Only the semaphores in the attributes table are considered.
+
+    stats: the array where the stats are copied
+    n: the max number of semaphores (length of the array)
+    return: the number of semaphores copied, -1 on failure
+*/
+HIDDEN void get_sem_stats(semstats_t *stats, u_int n) {
+    SYS_RETURN_VAL(old_area) = (stats != NULL) ? topSemStats(stats, n) : (u_int) FAILURE;
+}
+
+
+
+
+/*
+    This syscall makes the caller a real-time process, scheduled by earliest deadline first
+    ahead of the others: at the start of each period it's given budget clocks of CPU to be
+    used within deadline clocks, a job that uses its whole budget waits for the next period.
+    The process is admitted only if the total utilisation (budget / deadline) of the real-time
+    processes stays under 90%. The first job starts right away.
+
+    period: the period of the releases (in clocks), 0 to turn the caller back to a normal process
+    budget: the CPU time of each job (in clocks)
+    deadline: the deadline of each job from the start of the period (in clocks), 0 for the period
+    return: 0 on success, -1 if the parameters are invalid or the caller isn't admitted
+*/
+HIDDEN void edf_register_proc(u_int period, u_int budget, u_int deadline) {
+    update_time(KER_MD_TIME, TOD_LO);
+    SYS_RETURN_VAL(old_area) = scheduler_edf_register(getCurrentProc(), period, budget, deadline);
+}
+
+
+/*
+    This syscall ends the current job of a real-time caller, that waits for the start of
+    the next period (right away if it's already started)
+
+    return: the number of jobs that missed their deadline so far, -1 if the caller isn't real-time
+*/
+HIDDEN void edf_wait_release(void) {
+    pcb_t *caller = getCurrentProc();
+
+    if (caller->p_edf.period == 0) {
+        SYS_RETURN_VAL(old_area) = FAILURE;
+        return ;
+    }
+
+    update_time(KER_MD_TIME, TOD_LO);
+    u_int must_wait = scheduler_edf_wait(caller);
+    SYS_RETURN_VAL(old_area) = caller->p_edf.misses;
+
+    if (must_wait) {
+        cloneState(&caller->p_s, old_area, sizeof(state_t));
+        setCurrentProc(NULL);
+        scheduler();
+    }
+}
+
+
+
+
+/*
+    This syscall sets the tickets of a process, under the stride scheduling (SCHED_POLICY=stride)
+    the ready processes share the CPU in the ratios of their tickets
+
+    pid: the process, NULL for the caller
+    tickets: the new number of tickets, from 1 to STRIDE_MAX_TICKETS
+    return: 0 on success, -1 on failure
+*/
+HIDDEN void set_tickets(pcb_t *pid, u_int tickets) {
+    pcb_t *target = (pid != NULL) ? pid : getCurrentProc();
+
+    if (tickets == 0 || tickets > STRIDE_MAX_TICKETS) {
+        SYS_RETURN_VAL(old_area) = FAILURE;
+        return ;
+    }
+
+    // The pass already reached doesn't change, the new stride is used from now on
+    target->p_tickets = tickets;
+    SYS_RETURN_VAL(old_area) = SUCCESS;
+}
+
+
+
+
+/*
+    This syscall puts a process and all its descendants in a new group with a CPU quota:
+    together they can use at most quota clocks of CPU each period, then they are throttled
+    till the next period. The children created later join the group of the parent.
+    With a quota of 0 the processes are taken out of any group.
+
+    pid: the root of the subtree, NULL for the caller
+    quota: the CPU time of the group each period (in clocks), 0 to remove the subtree from its group
+    period: the length of the period (in clocks)
+    return: 0 on success, -1 if the arguments are invalid or there are no free groups
+*/
+HIDDEN void set_quota(pcb_t *pid, u_int quota, u_int period) {
+    pcb_t *dynasty_vector[MAXPROC];
+    group_t *group = NULL;
+
+    dynasty_vector[0] = (pid != NULL) ? pid : getCurrentProc();
+    SYS_RETURN_VAL(old_area) = FAILURE;
+
+    if (quota > period || (quota && (group = allocGroup(quota, period)) == NULL))
+        return ;
+
+    populate_PCB_tree(dynasty_vector, MAXPROC);
+    for (u_int i = 0; i < MAXPROC && dynasty_vector[i] != NULL; i++)
+        scheduler_set_group(dynasty_vector[i], group);
+
+    SYS_RETURN_VAL(old_area) = SUCCESS;
+}
+
+
+
+
+/*
+    This syscall gives up the rest of the time slice of the caller, that is put back in
+    the ready queue behind its peers (as spin-wait loops should do)
+
+    return: 0
+*/
+HIDDEN void yield(void) {
+    SYS_RETURN_VAL(old_area) = SUCCESS;
+    cloneState(&getCurrentProc()->p_s, old_area, sizeof(state_t));
+    update_time(KER_MD_TIME, TOD_LO);
+    scheduler_yield();
+}
+
+
+/*
+    This syscall donates the rest of the time slice of the caller to the given ready
+    process, that is executed right away. The caller is put back in the ready queue.
+
+    pid: the process to be executed
+    return: 0 on success, -1 if the process isn't ready (the caller goes on)
+*/
+HIDDEN void yield_to(pcb_t *pid) {
+    SYS_RETURN_VAL(old_area) = SUCCESS;
+    cloneState(&getCurrentProc()->p_s, old_area, sizeof(state_t));
+    update_time(KER_MD_TIME, TOD_LO);
+
+    // It returns only if the process can't be executed
+    SYS_RETURN_VAL(old_area) = scheduler_yield_to(pid);
+}
+
+
+
+/*
+    This syscall changes the base priority of a process or of all its subtree at runtime
+    (e.g. to lower the one of a batch job under load). The processes in the ready queue or
+    blocked on a semaphore sorted by priority are moved to the new place, the priority
+    inherited from the mutexes they own is kept.
+
+    pid: the process (or the root of the subtree), NULL for the caller
+    priority: the new base priority
+    tree: TRUE to set the priority of the descendants too
+    return: 0
+*/
+HIDDEN void set_priority(pcb_t *pid, int priority, u_int tree) {
+    pcb_t *dynasty_vector[MAXPROC];
+
+    dynasty_vector[0] = (pid != NULL) ? pid : getCurrentProc();
+    dynasty_vector[1] = NULL;
+
+    if (tree)
+        populate_PCB_tree(dynasty_vector, MAXPROC);
+    for (u_int i = 0; i < MAXPROC && dynasty_vector[i] != NULL; i++)
+        scheduler_set_base_priority(dynasty_vector[i], priority);
+
+    SYS_RETURN_VAL(old_area) = SUCCESS;
+}
+
+
+
 /* ========== SYSCALL & BREAKPOINT HANDLER ========== */
 
 /* 
@@ -294,6 +1130,34 @@ void syscallDispatcher(u_int sysNumber) {
             passeren((int*)SYS_ARG_1(old_area));
             break;
 
+        case PASSERENTIMED:
+            passeren_timed((int*)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area));
+            break;
+
+        case SEMWAITANY:
+            passeren_any((int**)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area));
+            break;
+
+        case BARRIERWAIT:
+            barrier_wait((barrier_t*)SYS_ARG_1(old_area));
+            break;
+
+        case SEMBROADCAST:
+            sem_broadcast((int*)SYS_ARG_1(old_area));
+            break;
+
+        case RWLOCK:
+            rw_lock((rwlock_t*)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area));
+            break;
+
+        case SEMOP:
+            sem_op((semop_t*)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area));
+            break;
+
+        case SEMCTL:
+            sem_ctl((u_int)SYS_ARG_1(old_area), (int*)SYS_ARG_2(old_area), (u_int)SYS_ARG_3(old_area));
+            break;
+
         case WAITIO:
             wait_IO((u_int)SYS_ARG_1(old_area), (u_int*)SYS_ARG_2(old_area), (int)SYS_ARG_3(old_area));
             break;
@@ -306,6 +1170,74 @@ void syscallDispatcher(u_int sysNumber) {
             get_PID_PPID((void**)SYS_ARG_1(old_area), (void**)SYS_ARG_2(old_area));
             break;
 
+        case DISKWRITE:
+            disk_write((u_int)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area), (void*)SYS_ARG_3(old_area));
+            break;
+
+        case DISKSYNC:
+            disk_sync();
+            break;
+
+        case TERMWRITE:
+            term_write((char*)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area), (u_int)SYS_ARG_3(old_area));
+            break;
+
+        case READLINE:
+            read_line((char*)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area), (u_int)SYS_ARG_3(old_area));
+            break;
+
+        case EVLOGDRAIN:
+            evlog_set_drain((int)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area), (u_int)SYS_ARG_3(old_area));
+            break;
+
+        case SEMSTATS:
+            get_sem_stats((semstats_t*)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area));
+            break;
+
+        case GETDEVSTATS:
+            get_dev_stats((u_int*)SYS_ARG_1(old_area), (int)SYS_ARG_2(old_area), (dev_stats_t*)SYS_ARG_3(old_area));
+            break;
+
+        case RSEQREGISTER:
+            rseq_register((memaddr)SYS_ARG_1(old_area), (memaddr)SYS_ARG_2(old_area));
+            break;
+
+        case USEMP:
+            usem_passeren((usem_t*)SYS_ARG_1(old_area));
+            break;
+
+        case USEMV:
+            usem_verhogen((usem_t*)SYS_ARG_1(old_area));
+            break;
+
+        case EDFREGISTER:
+            edf_register_proc((u_int)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area), (u_int)SYS_ARG_3(old_area));
+            break;
+
+        case EDFWAIT:
+            edf_wait_release();
+            break;
+
+        case SETTICKETS:
+            set_tickets((pcb_t*)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area));
+            break;
+
+        case SETQUOTA:
+            set_quota((pcb_t*)SYS_ARG_1(old_area), (u_int)SYS_ARG_2(old_area), (u_int)SYS_ARG_3(old_area));
+            break;
+
+        case YIELD:
+            yield();
+            break;
+
+        case YIELDTO:
+            yield_to((pcb_t*)SYS_ARG_1(old_area));
+            break;
+
+        case SETPRIORITY:
+            set_priority((pcb_t*)SYS_ARG_1(old_area), (int)SYS_ARG_2(old_area), (u_int)SYS_ARG_3(old_area));
+            break;
+
         default:
             loadCustomHandler(SYS_BP_COSTUM, old_area);
     }
@@ -332,7 +1264,11 @@ void syscall_breakpoint_handler(void) {
 
     // Checsks if the code is for a syscall and not a breakpoint
     if (exCode == SYSCALL_CODE) {  
-        u_int numberOfSyscall = SYSCALL_NO(old_area);
+        // A SEMOP waken up is executed again, its registers could hold the return value instead
+        pcb_t *caller = getCurrentProc();
+        u_int numberOfSyscall = (caller->p_semop != NULL) ? SEMOP : SYSCALL_NO(old_area);
+        caller->p_syscall = numberOfSyscall;
+        LOG_EVENT(EV_SYSCALL, numberOfSyscall, getCurrentProc());
         syscallDispatcher(numberOfSyscall);
     }
 
@@ -346,5 +1282,12 @@ void syscall_breakpoint_handler(void) {
     
     // At last update the kernel mode execution time
     update_time(KER_MD_TIME, TOD_LO);
+
+    // A process waken up by the syscall (e.g. with a V) with a higher priority runs on return
+    if (scheduler_must_preempt()) {
+        cloneState(&getCurrentProc()->p_s, old_area, sizeof(state_t));
+        scheduler_preempt();
+    }
+
     LDST(old_area);
 }
@@ -0,0 +1,100 @@
+#include "../include/system_const.h"
+#include "../include/types_bikaya.h"
+#include "../devices/disk_utils.h"
+#include "event_log.h"
+
+
+// In-memory ring of the log, always written even if there's no drain
+HIDDEN evlog_record_t evlog_ring[EVLOG_RECORDS];
+HIDDEN u_int evlog_next = 0;
+
+// Disk area where the log is drained (drain_disk < 0 if disabled), used circularly
+HIDDEN int drain_disk = -1;
+HIDDEN u_int drain_first = 0, drain_blocks = 0, drain_next = 0;
+// Blocks that couldn't be drained (the disk cache was full or the block was overwritten before)
+HIDDEN u_int drain_dropped = 0;
+// First record of the half of the ring waiting to be drained, -1 if none
+HIDDEN int drain_pending = -1;
+
+
+
+/*
+    Hands the half of the ring completed since the last call (if any) to the disk write-back
+    cache, that copies it, so the drain never waits for the device. If the cache is full the
+    block is dropped and the drop is recorded in the log itself.
+    The events are logged in the middle of the disk cache and of the interrupt handlers too,
+    so the drain is deferred to the scheduler (through LOG_DRAIN), out of them.
+
+    return: void
+*/
+void evlog_drain_pending(void) {
+    int *wait_sem = NULL;
+
+    if (drain_pending < 0 || drain_disk < 0)
+        return ;
+
+    evlog_record_t *completed = &evlog_ring[drain_pending];
+    drain_pending = -1;
+
+    if (disk_cache_write(drain_disk, drain_first + drain_next, completed, &wait_sem) == SUCCESS)
+        drain_next = (drain_next + 1 < drain_blocks) ? drain_next + 1 : 0;
+
+    else {
+        drain_dropped++;
+        evlog_write(EV_LOG_DROP, drain_dropped, 0);
+    }
+}
+
+
+/*
+    Appends a fixed size record to the event log, it costs a few stores so it can be
+    used on the hot paths of the kernel (usually through the LOG_EVENT macro)
+
+    id: the event identifier (see evlog_format.h)
+    arg1, arg2: the event arguments
+    return: void
+*/
+void evlog_write(u_int id, u_int arg1, u_int arg2) {
+    evlog_record_t *record = &evlog_ring[evlog_next];
+
+    record->tod = TOD_LO;
+    record->id = id;
+    record->arg[0] = arg1;
+    record->arg[1] = arg2;
+
+    evlog_next = (evlog_next + 1) & (EVLOG_RECORDS - 1);
+
+    // A half of the ring (a disk block) is complete, if the other one is still pending it's about to be overwritten
+    if ((evlog_next & (EVLOG_BLOCK_RECORDS - 1)) == 0 && drain_disk >= 0) {
+        (drain_pending >= 0) ? drain_dropped++ : 0;
+        drain_pending = (evlog_next + EVLOG_BLOCK_RECORDS) & (EVLOG_RECORDS - 1);
+    }
+}
+
+
+/*
+    Sets the disk area where the log is drained, a block at time as soon as it is complete.
+    The area is used circularly, so it holds the last blocks records of the log.
+
+    disk_no: the disk where the log is written, a negative value disables the drain
+    first_block: the first block of the area
+    blocks: the number of blocks of the area
+    return: 0 on success, -1 on failure (or if the log is compiled out)
+*/
+int evlog_drain(int disk_no, u_int first_block, u_int blocks) {
+    // Nothing is logged, the area would never be written
+    #ifndef EVENT_LOG
+    return (FAILURE);
+    #endif
+
+    if (disk_no >= DEV_PER_INT || (disk_no >= 0 && blocks == 0))
+        return (FAILURE);
+
+    drain_disk = (disk_no < 0) ? -1 : disk_no;
+    drain_first = first_block;
+    drain_blocks = blocks;
+    drain_next = 0;
+    drain_pending = -1;
+
+    return (SUCCESS);
+}
@@ -0,0 +1,24 @@
+#ifndef __EVENT_LOG_H
+#define __EVENT_LOG_H
+
+#include "../include/types_bikaya.h"
+#include "evlog_format.h"
+
+// Records in the in-memory ring, two disk blocks so that one can be drained while the other fills
+#define EVLOG_RECORDS (2 * EVLOG_BLOCK_RECORDS)
+
+// Logging is compiled in unless disabled with the EVENT_LOG CMake option
+#ifdef EVENT_LOG
+#define LOG_EVENT(id, arg1, arg2) evlog_write((id), (u_int)(arg1), (u_int)(arg2))
+// Drains a completed block of the log, used by the scheduler out of the code that logs the events
+#define LOG_DRAIN() evlog_drain_pending()
+#else
+#define LOG_EVENT(id, arg1, arg2)
+#define LOG_DRAIN()
+#endif
+
+void evlog_write(u_int id, u_int arg1, u_int arg2);
+void evlog_drain_pending(void);
+int evlog_drain(int disk_no, u_int first_block, u_int blocks);
+
+#endif
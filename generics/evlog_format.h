@@ -0,0 +1,35 @@
+#ifndef __EVLOG_FORMAT_H
+#define __EVLOG_FORMAT_H
+
+/****************************************************************************
+ *
+ * Binary format of the kernel event log, shared by the kernel and by the
+ * host side decoder (tools/evlog_decode.c), so it must not include any
+ * target architechture header.
+ *
+ ****************************************************************************/
+
+// Event identifiers (the meaning of the two arguments is next to each one)
+#define EV_NONE        0   // Unused record
+#define EV_DISPATCH    1   // pcb, priority
+#define EV_SYSCALL     2   // syscall number, pcb
+#define EV_INTERRUPT   3   // interrupt line, interrupted pcb
+#define EV_BLOCK       4   // semaphore key, pcb
+#define EV_TERMINATE   5   // pcb, caller pcb
+#define EV_DISK_WRITE  6   // disk number, block number
+#define EV_LOG_DROP    7   // number of blocks of the log that couldn't be drained, 0
+
+#define EV_NUM         8
+
+// A record of the log, fixed size (16 bytes) so that a disk block holds exactly EVLOG_BLOCK_RECORDS
+typedef struct evlog_record_t {
+    // Low word of the TOD at wich the event happened
+    unsigned int tod;
+    unsigned int id;
+    unsigned int arg[2];
+} evlog_record_t;
+
+#define EVLOG_RECORD_SIZE   16
+#define EVLOG_BLOCK_RECORDS 256
+
+#endif
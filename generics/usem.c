@@ -0,0 +1,63 @@
+#include "../include/system_const.h"
+#include "../include/types_bikaya.h"
+#include "usem.h"
+
+
+// Bounds of the restartable sequences of the fast paths, defined in the assembly files
+extern char usem_rseq_p_start[], usem_rseq_p_end[];
+extern char usem_rseq_v_start[], usem_rseq_v_end[];
+
+
+
+/*
+    Registers the fast paths as restartable sequences of the caller, must be called
+    by each process before using the user semaphores (or inherited from the parent,
+    since the registered sequences are copied in the children by CREATEPROCESS)
+
+    return: 0 on success, -1 if there aren't enough free sequences
+*/
+int usem_register(void) {
+    if ((int) SYSCALL(RSEQREGISTER, (memaddr) usem_rseq_p_start, (memaddr) usem_rseq_p_end, 0) == FAILURE)
+        return (FAILURE);
+
+    return ((int) SYSCALL(RSEQREGISTER, (memaddr) usem_rseq_v_start, (memaddr) usem_rseq_v_end, 0));
+}
+
+
+/*
+    Initializes a user semaphore with the given value, as USEM_INITIALIZER
+
+    sem: the semaphore to be initialized
+    value: the initial value (not negative)
+    return: void
+*/
+void usem_init(usem_t *sem, int value) {
+    sem->value = value;
+    sem->waiters = 0;
+}
+
+
+/*
+    P operation on a user semaphore, it traps into the kernel only if the
+    semaphore value isn't positive (the caller has to be blocked)
+
+    sem: the semaphore to be requested
+    return: void
+*/
+void usem_p(usem_t *sem) {
+    if (! usem_try_p(sem))
+        SYSCALL(USEMP, (memaddr) sem, 0, 0);
+}
+
+
+/*
+    V operation on a user semaphore, it traps into the kernel only if
+    there are processes waiting to be waken up
+
+    sem: the semaphore to be released
+    return: void
+*/
+void usem_v(usem_t *sem) {
+    if (! usem_try_v(sem))
+        SYSCALL(USEMV, (memaddr) sem, 0, 0);
+}
@@ -0,0 +1,18 @@
+#ifndef __USEM_H
+#define __USEM_H
+
+#include "../include/types_bikaya.h"
+
+// Static initializer of a user semaphore with the given value
+#define USEM_INITIALIZER(val) { (val), 0 }
+
+int usem_register(void);
+void usem_init(usem_t *sem, int value);
+void usem_p(usem_t *sem);
+void usem_v(usem_t *sem);
+
+// Fast paths (usem_umps.S and usem_uarm.s), return TRUE on success
+int usem_try_p(usem_t *sem);
+int usem_try_v(usem_t *sem);
+
+#endif
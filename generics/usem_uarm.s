@@ -0,0 +1,61 @@
+/*
+ * Fast paths of the user semaphores (uARM), see usem.c
+ *
+ * Each fast path is a restartable sequence: it reads the semaphore and
+ * commits the new value with a single store, the last instruction of the
+ * sequence. If the process is preempted before the store the kernel
+ * brings the PC back to the start label, so the sequence is executed
+ * again from the beginning with fresh values.
+ */
+
+.equ USEM_VALUE,	0
+.equ USEM_WAITERS,	4
+
+
+/* int usem_try_p(usem_t *sem)                           *
+ * decrements the semaphore if its value is positive,    *
+ * returns 1 on success, 0 if the caller has to trap     */
+
+.global usem_try_p
+.global usem_rseq_p_start
+.global usem_rseq_p_end
+
+usem_try_p:
+usem_rseq_p_start:
+    LDR r1, [r0, #USEM_VALUE]
+    CMP r1, #0
+    BLE usem_try_p_fail
+    SUB r1, r1, #1
+    STR r1, [r0, #USEM_VALUE]
+usem_rseq_p_end:
+    MOV r0, #1
+    BX lr
+
+usem_try_p_fail:
+    MOV r0, #0
+    BX lr
+
+
+/* int usem_try_v(usem_t *sem)                           *
+ * increments the semaphore if no process is waiting,    *
+ * returns 1 on success, 0 if the caller has to trap     */
+
+.global usem_try_v
+.global usem_rseq_v_start
+.global usem_rseq_v_end
+
+usem_try_v:
+usem_rseq_v_start:
+    LDR r1, [r0, #USEM_WAITERS]
+    CMP r1, #0
+    BGT usem_try_v_fail
+    LDR r1, [r0, #USEM_VALUE]
+    ADD r1, r1, #1
+    STR r1, [r0, #USEM_VALUE]
+usem_rseq_v_end:
+    MOV r0, #1
+    BX lr
+
+usem_try_v_fail:
+    MOV r0, #0
+    BX lr
@@ -2,6 +2,7 @@
 #include "../include/types_bikaya.h"
 #include "../include/system_const.h"
 #include "../process/scheduler.h"
+#include "../process/group.h"
 #include "./utils.h"
 
 
@@ -21,6 +22,22 @@ void wipe_Memory(void *memaddr, u_int size) {
 }
 
 
+/*
+    Copy size bytes from the src memory location to the dest one (moreless like _memcpy),
+    the two areas must not overlap
+
+    dest: the memory location to be written
+    src: the memory location to be copied
+    size: the size in bytes of the area that has to be copied
+*/
+void copy_Memory(void *dest, void *src, u_int size) {
+    unsigned char *to = dest, *from = src;
+
+    while(size--)
+        *to++ = *from++;
+}
+
+
 /*
     Initialize a new area for exception handling pourpose, sets all the option of the state registers,
     initialize stack pointer and program counter and so on
@@ -113,6 +130,24 @@ void cloneState(state_t *process_state, state_t *old_area, u_int size) {
 }
 
 
+/*
+    If the PC of the given state is inside one of the restartable sequences, it is brought
+    back to the start of the sequence, so that the interrupted sequence is executed again
+    from the beginning (none of its effects is visible before the last instruction)
+
+    state: the state of the preempted process
+    rseq: the restartable sequences registered by the process (RSEQ_MAX long)
+    return: void
+*/
+void rseq_rollback(state_t *state, rseq_t *rseq) {
+    for (u_int i = 0; i < RSEQ_MAX; i++)
+        if (PC_REG(state) >= rseq[i].start && PC_REG(state) < rseq[i].end) {
+            PC_REG(state) = rseq[i].start;
+            return ;
+        }
+}
+
+
 /*
     This function initialize the time_t struct of a PCB, if the struct has been
     already initialized then the function stops & returns
@@ -152,8 +187,9 @@ void update_time(u_int option, u_int current_clock) {
     u_int *counterToUpdate = option ? &tmp->p_time.kernelmode_time : &tmp->p_time.usermode_time;
     u_int *last_update_clock = &tmp->p_time.last_update_time;
     
-    // Get the elapsed clock and add it t the selcted counter
+    // Get the elapsed clock and add it t the selcted counter (and to the quota of the process group)
     *counterToUpdate += current_clock - *last_update_clock;
+    group_charge(tmp, current_clock - *last_update_clock);
     // Update the "last_update" field with the new value
     *last_update_clock = current_clock;
 }
@@ -163,6 +163,20 @@ static inline void list_del(struct list_head *entry)
 	__list_del(entry->prev, entry->next);
 }
 
+/*
+    Rimuove l'elemento entry dalla lista in cui e' contenuto e lo reinizializza
+    come lista vuota, cosi' che list_empty(entry) indichi se e' in una lista.
+
+    entry: elemento da rimuovere
+
+    return: void
+*/
+static inline void list_del_init(struct list_head *entry)
+{
+	__list_del(entry->prev, entry->next);
+	INIT_LIST_HEAD(entry);
+}
+
 /*
     Funzione che controlla se la lista e' arrivata alla fine
 
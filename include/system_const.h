@@ -26,6 +26,13 @@
 #define MAXPROC 20  // Max number of overall (eg, system, daemons, user) concurrent processes 
 #define UPROCMAX 3  // Number of usermode processes (not including master proc and system daemons
 #define DEFAULT_PRIORITY 1
+#define RSEQ_MAX 4  // Max number of restartable sequences a process can register
+#define MAXSEMATTR 20  // Max number of semaphores with attributes (set with SEMCTL) at the same time
+#define SEM_PRIO_BUCKETS 8  // Priority levels of the semaphores queues (higher priorities share the last one)
+#define SEMWAIT_MAX 4  // Max number of semaphores a process can wait on at once (wait-any)
+#define RWLOCK_MAX 4  // Max number of reader-writer locks a process can hold at once (RWLOCK)
+#define MAXGROUPS 8  // Max number of process groups with a CPU quota (set with SETQUOTA)
+#define MAXSEMD (MAXPROC * SEMWAIT_MAX)  // Number of semaphore descriptors
 
 #define	HIDDEN static
 #define	TRUE 	1
@@ -46,11 +53,19 @@
 #define MULTIPLE_DEV_LINE 5
 #define WORDSIZE 4
 #define DEV_PER_INT 8
-#define DEV_REGISTER_SIZE 4
-#define REGISTER_PER_DEV 4
+
+// Shifts used to obtain a device descriptor index from a device register address
+#define DEV_REG_SHIFT     4   // log2(DEV_REG_SIZE)
+#define DEV_PER_INT_SHIFT 3   // log2(DEV_PER_INT)
+// Number of device descriptors (the terminal is counted twice for receiving an transmission)
+#define DEV_DESC_NUM ((MULTIPLE_DEV_LINE + 1) * DEV_PER_INT)
 
 #define TIME 3000
 #define TIME_SLICE (TIME * TIME_SCALE)
+// How much the priority of a waken up process must exceed the running one's to preempt it (0 never)
+#ifndef PREEMPT_MARGIN
+#define PREEMPT_MARGIN 1
+#endif
 #define USR_MD_TIME 0
 #define KER_MD_TIME 1
 
@@ -271,9 +286,63 @@
 #define SPECPASSUP       7
 #define GETPID           8
 
+// Extended syscalls, numbered from 20 so that the ones in between are left to the custom handlers
+#define DISKWRITE        20
+#define DISKSYNC         21
+#define GETDEVSTATS      22
+#define TERMWRITE        23
+#define READLINE         24
+#define EVLOGDRAIN       25
+#define RSEQREGISTER     26
+#define USEMP            27
+#define USEMV            28
+#define SEMOP            29
+#define SEMCTL           30
+#define PASSERENTIMED    31
+#define SEMWAITANY       32
+#define BARRIERWAIT      33
+#define SEMBROADCAST     34
+#define RWLOCK           35
+#define SEMSTATS         36
+#define EDFREGISTER      37
+#define EDFWAIT          38
+#define SETTICKETS       39
+#define SETQUOTA         40
+#define YIELD            41
+#define YIELDTO          42
+#define SETPRIORITY      43
+
+// Max number of operations applied by a single SEMOP syscall
+#define SEMOP_MAX        16
+
+// Operations of the RWLOCK syscall
+#define RW_READ_LOCK     0
+#define RW_READ_UNLOCK   1
+#define RW_WRITE_LOCK    2
+#define RW_WRITE_UNLOCK  3
+
+// Commands of the SEMCTL syscall
+#define SEM_MUTEX        0
+#define SEM_WAKEPOLICY   1
+#define SEM_HANDOFF      2
+
+// Wake policies of the semaphores (SEM_WAKEPOLICY argument)
+#define SEM_WAKE_FIFO     0
+#define SEM_WAKE_PRIORITY 1
+
+// Flags of the semaphore attributes
+#define SEMATTR_MUTEX    (1 << 0)
+#define SEMATTR_PRIORITY (1 << 1)
+#define SEMATTR_HANDOFF  (1 << 2)
+
 // Status code after syscall execution
 #define FAILURE -1
 #define SUCCESS 0
+#define TIMEOUT -2
+
+// Tickets of the stride scheduling, a process that hasn't set them has the default
+#define STRIDE_DEFAULT_TICKETS 100
+#define STRIDE_MAX_TICKETS     (1 << 16)
 
 
 
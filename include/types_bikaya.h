@@ -8,6 +8,26 @@
 typedef unsigned int memaddr;
 typedef unsigned int u_int;
 
+// Real-time parameters and state of a process in the EDF class (times in clocks)
+typedef struct edf_t {
+    // Period of the releases (0 if the process isn't real-time), CPU time and relative deadline of each job
+    unsigned int period;
+    unsigned int budget;
+    unsigned int deadline;
+
+    // Absolute deadline of the current job and start of the next period
+    unsigned int abs_deadline;
+    unsigned int release;
+    // CPU time used by the current job, TRUE if it used the whole budget
+    unsigned int used;
+    unsigned int throttled;
+
+    // Number of jobs that missed their deadline
+    unsigned int misses;
+} edf_t;
+
+
+
 // Custom exception handling for PCB (defined with specpassup syscall)
 typedef struct handler_t {
     // Matrix of custom handlers
@@ -28,10 +48,34 @@ typedef struct time_t {
 
 
 
+// Restartable sequence, a range of code [start, end) restarted from the beginning if preempted
+typedef struct rseq_t {
+    memaddr start;
+    memaddr end;
+} rseq_t;
+
+
+
+// Node that links a waiting process in a semaphore queue (a process waiting on several semaphores has one for each)
+typedef struct semwait_t {
+    struct list_head w_next;
+    struct pcb_t *w_proc;
+    // Semaphore descriptor of the queue, NULL if not linked
+    struct semd_t *w_semd;
+    // Priority bucket in the semaphore queue (SEM_PRIO_BUCKETS if inserted in FIFO order)
+    unsigned int w_bucket;
+    // Time of the insertion in the queue (TOD_LO), for the contention stats
+    unsigned int w_since;
+} semwait_t;
+
+
+
 // Process Control Block (PCB) data structure 
 typedef struct pcb_t {
     // Process queue fields 
     struct list_head p_next;
+    // TRUE while the process is in the ready queue, p_next links the free and throttled PCBs as well
+    unsigned int p_ready;
 
     // Process tree fields
     struct pcb_t *   p_parent;
@@ -47,16 +91,106 @@ typedef struct pcb_t {
     // Original process priority
     int original_priority;
 
-    // Key of the semaphore on which the process is eventually blocked
+    // Key of the semaphore on which the process is eventually blocked (the first one for a wait-any)
     int *p_semkey;
+    // Nodes linked in the semaphores queues, with the number in use and the index of the one waken up
+    semwait_t p_wait[SEMWAIT_MAX];
+    unsigned int p_nwait;
+    unsigned int p_waitindex;
+
+    // Last syscall made by the process (the one it's blocked on, if any), the saved registers
+    // can't tell it since in uARM the return value overwrites the syscall number
+    unsigned int p_syscall;
+    // SEMOP restarted when the process is waken up: blocking operation, operations left and units already taken
+    struct semop_t *p_semop;
+    unsigned int p_semop_left;
+    unsigned int p_semop_granted;
+
+    // Timer queue fields, the process is in the queue while it waits with a deadline (timed P)
+    struct list_head p_timer;
+    unsigned int p_deadline;
 
     // Set of possible custom exception handler for the process
     handler_t custom_handler;
+
+    // Registered restartable sequences (unused slots have an empty range)
+    rseq_t p_rseq[RSEQ_MAX];
+
+    // Reader-writer locks held (NULL if the slot is free), TRUE for the ones held as writer
+    struct rwlock_t *p_rwlocks[RWLOCK_MAX];
+    unsigned int p_rwwriter[RWLOCK_MAX];
+
+    // Number of mutexes owned and highest priority inherited from the processes waiting on them
+    unsigned int owned_mutexes;
+    int inherited_priority;
+
+    // Multilevel feedback queue state (SCHED_MLFQ only): level and CPU time used at that level
+    unsigned int mlfq_level;
+    unsigned int mlfq_used;
+    // CPU time of the process the last time it was added to the ready queue
+    unsigned int p_cpu_time;
+    // Time slice left when the process was preempted before the end of it (0 for a new one)
+    unsigned int p_quantum_left;
+
+    // Heap fields, the key on wich the heap is sorted and the slot of the PCB
+    unsigned int p_heapkey;
+    unsigned int p_heapindex;
+    // Weighted CPU time used by the process (SCHED_FAIR only)
+    unsigned int p_vruntime;
+    // Tickets (0 for the default) and pass of the process (used by SCHED_STRIDE)
+    unsigned int p_tickets;
+    unsigned int p_pass;
+    // Real-time parameters (EDFREGISTER)
+    edf_t p_edf;
+
+    // Group with a CPU quota the process is member of (NULL if none), TRUE while it's throttled
+    struct group_t *p_group;
+    unsigned int p_throttled;
  
 } pcb_t;
 
 
 
+// Process group with a CPU bandwidth quota (SETQUOTA), times in clocks
+typedef struct group_t {
+    // CPU time the members can use together each period, 0 if the group is free
+    unsigned int quota;
+    unsigned int period;
+
+    // CPU time used in the current period and its start
+    unsigned int used;
+    unsigned int period_start;
+
+    unsigned int members;
+    // Members throttled till the next period (linked by p_next)
+    struct list_head throttled;
+} group_t;
+
+
+
+// Binary min heap of PCBs sorted by p_heapkey, with room for all of them
+typedef struct pcb_heap_t {
+    struct pcb_t *elem[MAXPROC];
+    unsigned int size;
+} pcb_heap_t;
+
+
+
+// Contention stats of a semaphore (returned as well by the SEMSTATS syscall)
+typedef struct semstats_t {
+    // Semaphore key (set only in the records returned by SEMSTATS)
+    int *key;
+    // Number of times a process has been blocked on the semaphore
+    unsigned int blocked;
+    // Total and max time (in clocks) spent in the queue
+    unsigned int total_wait;
+    unsigned int max_wait;
+    // Max length reached by the queue
+    unsigned int max_queue;
+} semstats_t;
+
+
+
 // Semaphore Descriptor (SEMD) data structure
 typedef struct semd_t {
     struct list_head s_next;
@@ -66,10 +200,120 @@ typedef struct semd_t {
 
     // Queue of PCBs blocked on the semaphore
     struct list_head s_procQ;
+    // Last PCB of each priority bucket in the queue (NULL if empty), used by the priority wake policy
+    struct list_head *s_tail[SEM_PRIO_BUCKETS];
+    // Number of PCBs in the queue
+    unsigned int s_len;
+
+    // Attributes of the semaphore (NULL if none), looked up once when the semd is taken from the free list
+    struct semattr_t *s_attr;
+    // Contention stats since the semd was taken, added to the attributes table when it's freed
+    semstats_t s_stats;
 } semd_t;
 
 
 
+// Attributes (set with SEMCTL) and stats of a semaphore, kept also when no process is blocked on it
+// (the stats of the processes blocked right now are still in the semd)
+typedef struct semattr_t {
+    // Semaphore key, NULL if the entry is free
+    int *key;
+    // Mode flags (SEMATTR_*)
+    unsigned int flags;
+
+    // Process that holds the semaphore in mutex mode
+    struct pcb_t *owner;
+
+    semstats_t stats;
+} semattr_t;
+
+
+
+// User semaphore, P and V trap into the kernel only when the semaphore is contended
+typedef struct usem_t {
+    // Value of the semaphore, never negative (the blocked processes are counted in waiters)
+    int value;
+    // Number of processes blocked in the kernel (killed ones are counted until the next V)
+    int waiters;
+} usem_t;
+
+
+
+// Barrier of the BARRIERWAIT syscall, it opens when parties processes have arrived
+typedef struct barrier_t {
+    int parties;
+    // Processes arrived so far, they are blocked on the address of this field
+    int arrived;
+} barrier_t;
+
+
+
+// Reader-writer lock of the RWLOCK syscall, must be initialized to all 0
+typedef struct rwlock_t {
+    // Readers holding the lock and TRUE if a writer holds it
+    int readers;
+    int writer;
+    // Keys on wich the waiting readers and writers are blocked (their value isn't used)
+    int read_queue;
+    int write_queue;
+} rwlock_t;
+
+
+
+// Semaphore operation of the SEMOP syscall, a positive delta is V(delta) and a negative one P(-delta)
+typedef struct semop_t {
+    int *semaddr;
+    int delta;
+} semop_t;
+
+
+
+// Utilisation stats of a device (returned as well by the GETDEVSTATS syscall)
+typedef struct dev_stats_t {
+    // Number of completed operations and bytes transferred
+    unsigned int ops;
+    unsigned int bytes;
+    // Total time (in clocks) the device has been busy executing requests
+    unsigned int busy_time;
+} dev_stats_t;
+
+
+
+// Device descriptor, there's one for each device (terminals have one for transmission and one for receiving)
+typedef struct dev_desc_t {
+    // Device register and its position on the interrupt lines
+    devreg_t *reg;
+    unsigned int line;
+    unsigned int dev_no;
+    unsigned int recv;
+
+    // Semaphore key on wich the processes waiting for the device are blocked
+    int wait_sem;
+    // Processes waiting for the device to be free, their request is still in the saved state
+    int queue_sem;
+    // TRUE if the device is driven by the kernel itself, WAITIO requests are refused
+    unsigned int reserved;
+    // TRUE while the kernel (disk cache) owns the device, and if it's waiting for its turn
+    unsigned int kernel_owned;
+    unsigned int kernel_waiting;
+
+    // Request in execution: TRUE while the device executes a command, the process that
+    // issued it (NULL for the kernel or if the process has been killed) and the command
+    unsigned int busy;
+    struct pcb_t *in_flight;
+    unsigned int command;
+    unsigned int busy_since;
+
+    // String in transmission, sent one char at time from the interrupt handler (TERMWRITE)
+    char *buf;
+    unsigned int buf_len;
+    unsigned int buf_pos;
+
+    dev_stats_t stats;
+} dev_desc_t;
+
+
+
 // Auxiliary structure for option register setting in both architecture
 // Used to setting better the option of a given process
 #ifdef TARGET_UMPS
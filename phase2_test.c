@@ -62,6 +62,9 @@
 
 #include "./include/system_const.h"
 #include "./include/types_bikaya.h"
+#include "./devices/disk_utils.h"
+#include "./generics/evlog_format.h"
+#include "./generics/usem.h"
 
 typedef unsigned int devregtr;
 typedef unsigned int cpu_t;
@@ -112,6 +115,131 @@ state_t p2state, p3state, p4state, p5state, p6state;
 state_t p7rootstate, child1state, child2state;
 state_t gchild1state, gchild2state, gchild3state, gchild4state;
 
+/* tests of the extended syscalls, run one at a time after p7 on its stack (see run_test) */
+#define TESTCHILDREN 4 /* max number of children of a test */
+
+state_t teststate, tchildstate[TESTCHILDREN];
+
+int endtest = 0, /* to signal the end of a test */
+    blktest = 0; /* to block a test (and its children) till p1 kills it */
+
+char p8wbuf[DISK_BLOCK_SIZE], p8rbuf[DISK_BLOCK_SIZE]; /* block written and read by p8 */
+
+#define P9WAIT (10 * TIME_SLICE) /* time p9 waits for its child to block */
+
+int p9sem1 = 1, /* taken by the first operation of p9's SEMOP */
+    p9sem2 = 0, /* the second one blocks on it */
+    p9done = 0; /* for p9's child to signal the end of its SEMOP */
+int     p9result = ERROR; /* return value of the child's SEMOP */
+semop_t p9ops[2] = { { &p9sem1, -1 }, { &p9sem2, -2 } };
+semop_t p9bad[2] = { { &p9sem1, 1 }, { NULL, -1 } }; /* the second operation is invalid */
+
+#define P10WAIT (5 * TIME_SLICE) /* timeout of p10's timed P */
+
+int p10sem = 1; /* for p10's timed P */
+
+#define P11TOP  (DEFAULT_PRIORITY + 6) /* priority of p11, so that it isn't preempted by its children */
+#define P11PRIO (DEFAULT_PRIORITY + 4) /* priority of the process waiting on p11's mutex */
+#define P11MID  (DEFAULT_PRIORITY + 2) /* priority of the process that mustn't run before the owner */
+#define P11WAIT (10 * TIME_SLICE)      /* time p11 sleeps for its children to block */
+
+int   p11mutex = 1, /* semaphore in mutex mode */
+      p11held  = 0, /* for the owner to signal it holds the mutex */
+      p11hold  = 0, /* to block the owner while it holds the mutex */
+      p11sleep = 0, /* never signaled, p11 sleeps on it with a timeout */
+      p11done  = 0; /* for p11's children to signal their end */
+pid_t p11waiterpid, p11midpid;
+pid_t p11first = 0; /* first of the owner (after the release) and the other children to run */
+
+#define P12PERIOD (10 * TIME_SLICE) /* period of p12 as a real-time process */
+#define P12BUDGET TIME_SLICE        /* CPU time of each of its jobs */
+
+#define P13PERIOD (10 * TIME_SLICE) /* period of p13's group quota */
+#define P13QUOTA  TIME_SLICE        /* CPU time of the group each period */
+
+#define P14TOP (DEFAULT_PRIORITY + 10) /* priority of p14, so that its child doesn't run when created */
+
+int p14ran = 0; /* set by p14's child when it runs */
+
+#define P15TOP  (DEFAULT_PRIORITY + 10) /* priority of p15, so that its children don't run when created */
+#define P15PRIO (DEFAULT_PRIORITY + 6)  /* priority given to p15's children, above the aging of the others */
+#define P15WAIT (10 * TIME_SLICE)      /* time p15 sleeps for its children to block */
+
+int   p15sem   = 0, /* semaphore sorted by priority, p15's children block on it */
+      p15sleep = 0, /* never signaled, p15 sleeps on it with a timeout */
+      p15done  = 0; /* for p15's children to signal their end */
+pid_t p15child1pid, p15child2pid;
+pid_t p15first = 0; /* first of p15's children to run (after its wait, if any) */
+
+#define P16WAIT    (5000 * TIME_SLICE) /* time given to type a line on terminal 0 (about 15 seconds) */
+#define P16LINELEN 64
+
+int  p16done = 0;     /* for p16's child to signal the end of its READLINE */
+int  p16len  = ERROR; /* return value of the READLINE */
+char p16line[P16LINELEN];
+
+#define P17WAIT (10 * TIME_SLICE) /* time p17 sleeps for its children to block */
+
+barrier_t p17bar = {3, 0};  /* barrier of p17 and of two of its children */
+int p17sem    = 0,          /* semaphore p17's children are waken up from with SEMBROADCAST */
+    p17sleep  = 0,          /* never signaled, p17 sleeps on it with a timeout */
+    p17done   = 0,          /* for p17's children to signal their end */
+    p17passed = 0;          /* children that passed the barrier (or the semaphore) */
+
+#define P18WAIT (10 * TIME_SLICE) /* time p18 waits for its children */
+
+rwlock_t p18lock;          /* reader-writer lock of p18 and its children */
+int p18sleep  = 0,         /* never signaled, p18 sleeps on it with a timeout */
+    p18done   = 0,         /* for p18's children to signal that they hold the lock */
+    p18unlock = 0,         /* RWLOCK return value of the unlock by a child not holding the lock */
+    p18read   = 0;         /* set by the reader child when it gets the lock */
+
+char p19line[] = "p19 TERMWRITE writes this line\nerror: p19 TERMWRITE wrote past the length\n";
+#define P19LEN 31 /* length of the first line of p19line, its newline included */
+
+#define P20BLOCK 1 /* block of disk 0 where p20 drains the event log (block 0 is p8's) */
+
+evlog_record_t p20log[EVLOG_BLOCK_RECORDS]; /* block of the log read back by p20 */
+
+#define P21LOOPS 5000              /* critical sections of each of p21's workers */
+#define P21WAIT  (10 * TIME_SLICE) /* time p21 waits for its child to block */
+
+usem_t p21mutex = USEM_INITIALIZER(1), /* user semaphore shared by p21's workers */
+       p21sem   = USEM_INITIALIZER(0); /* p21's child blocks on it */
+int    p21count = 0,                   /* incremented by the workers holding p21mutex */
+       p21done  = 0;                   /* for p21's children to signal their end */
+
+#define P22WAIT (10 * TIME_SLICE) /* time p22 waits for its child */
+
+int  p22sem[3] = { 0, 0, 0 };                              /* semaphores p22 and its child wait on */
+int *p22sems[3] = { &p22sem[0], &p22sem[1], &p22sem[2] }; /* their keys, as SEMWAITANY takes them */
+int  p22done  = 0,                                        /* for p22's child to signal its end */
+     p22index = ERROR;                                    /* SEMWAITANY return value of the child */
+
+#define P23WAIT  (2 * TIME_SLICE) /* time p23's child waits on the less contended semaphore */
+#define P23STATS 16               /* max number of semaphores in the SEMSTATS ranking */
+
+int p23short = 0, /* p23's child waits P23WAIT on it */
+    p23long  = 0, /* and ten times as much on this one */
+    p23sleep = 0, /* never signaled, p23 sleeps on it with a timeout */
+    p23done  = 0; /* for p23's child to signal its end */
+semstats_t p23stats[P23STATS]; /* ranking returned by SEMSTATS */
+
+#define P24TOP   (DEFAULT_PRIORITY + 10) /* priority of p24, so that its children don't run when created */
+#define P24TURNS 10                      /* disk operations of p24's I/O bound child */
+
+int          p24stop = 0, /* to stop p24's CPU bound child */
+             p24done = 0; /* for p24's children to signal their end */
+unsigned int p24tod[P24TURNS]; /* times of day the I/O bound child starts its operations */
+
+#define P25PRIO (DEFAULT_PRIORITY + PREEMPT_MARGIN + 2) /* priority of p25's child waken up by a V */
+#define P25TOP  (P25PRIO + 4)                           /* priority of p25, so that its children don't run when created */
+
+int p25sem   = 0, /* p25's high priority child blocks on it */
+    p25done  = 0, /* for p25's children to signal their end */
+    p25after = 0, /* set by the low priority child right after its V */
+    p25seen  = 1; /* p25after when the high priority child got the CPU back */
+
 /* trap states for p4 */
 state_t pstat_n, mstat_n, sstat_n, pstat_o, mstat_o, sstat_o;
 
@@ -131,6 +259,22 @@ pid_t leaf1pid, leaf2pid, leaf3pid, leaf4pid;
 
 void p2(), p3(), p4(), p4a(), p4b(), p5(), p6(), p6a();
 void p7root(), child1(), child2(), p7leaf();
+void run_test(), end_test();
+pid_t start_child();
+void p8(), p9(), p9child(), p10();
+void p11(), p11owner(), p11waiter(), p11mid(), p11record(), p12(), p13();
+void p14(), p14child();
+void p15(), p15run(), p15child();
+void p16(), p16reader();
+void p17(), p17waiter(), p17bcast();
+void p18(), p18reader(), p18writer();
+void p19();
+void p20(), p20drain();
+void p21(), p21worker(), p21waiter();
+void p22(), p22child();
+void p23(), p23child();
+void p24(), p24slice(), p24spin(), p24io();
+void p25(), p25high(), p25low();
 
 unsigned int set_sp_pc_status(state_t *s, state_t *copy, unsigned int pc, unsigned int frames) {
     STST(s);
@@ -228,6 +372,7 @@ void test() {
     set_sp_pc_status(&gchild3state, &gchild2state, (unsigned int)p7leaf, 1);
     set_sp_pc_status(&gchild4state, &gchild3state, (unsigned int)p7leaf, 1);
 
+
     /* create process p2 */
     SYSCALL(CREATEPROCESS, (int)&p2state, DEFAULT_PRIORITY, 0); /* start p2     */
     print("p2 was started\n");
@@ -279,6 +424,27 @@ void test() {
         SYSCALL(VERHOGEN, (int)&blkp7child, 0, 0);
     }
 
+    /* the extended syscall tests */
+    run_test(p8);
+    run_test(p9);
+    run_test(p10);
+    run_test(p11);
+    run_test(p12);
+    run_test(p13);
+    run_test(p14);
+    run_test(p15);
+    run_test(p16);
+    run_test(p17);
+    run_test(p18);
+    run_test(p19);
+    run_test(p20);
+    run_test(p21);
+    run_test(p22);
+    run_test(p23);
+    run_test(p24);
+    run_test(p25);
+    print("p1 knows the extended syscall tests ended\n");
+
     print("\n");
 
     print("p1 finishes OK -- TTFN\n");
@@ -636,6 +802,955 @@ void p7leaf() {
     PANIC();
 }
 
+/* Runs an extended syscall test on p7's stack (p7 is gone): p1 waits for the end of */
+/* the test, then kills it with its children, so no process is left to the next one */
+void run_test(void (*code)()) {
+    pid_t pid;
+
+    set_sp_pc_status(&teststate, &p6state, (unsigned int)code, 1);
+    SYSCALL(CREATEPROCESS, (int)&teststate, DEFAULT_PRIORITY, (int)&pid);
+
+    SYSCALL(PASSEREN, (int)&endtest, 0, 0);
+    SYSCALL(TERMINATEPROCESS, (int)pid, 0, 0);
+}
+
+/* ends the running test, that is blocked till p1 kills it */
+void end_test() {
+    SYSCALL(VERHOGEN, (int)&endtest, 0, 0);
+    SYSCALL(PASSEREN, (int)&blktest, 0, 0);
+
+    print("error: test not killed after its end\n");
+    PANIC();
+}
+
+/* starts the i-th child of the running test, each one on the frame below the previous one */
+pid_t start_child(int i, void (*code)(), int priority) {
+    pid_t pid;
+
+    set_sp_pc_status(&tchildstate[i], (i == 0) ? &teststate : &tchildstate[i - 1], (unsigned int)code, 1);
+    SYSCALL(CREATEPROCESS, (int)&tchildstate[i], priority, (int)&pid);
+
+    return pid;
+}
+
+/* reads block 0 of disk 0 in p8rbuf with WAITIO and compares it with p8wbuf */
+int p8read() {
+    dtpreg_t *disk = (dtpreg_t *)DEV_REG_ADDR(IL_DISK, 0);
+    int       i, status;
+
+    for (i = 0; i < DISK_BLOCK_SIZE; i++)
+        p8rbuf[i] = 0;
+
+    status = SYSCALL(WAITIO, DISK_SEEKCYL | (0 << DISK_CYL_SHIFT), (int)disk, FALSE);
+    if ((status & DISK_STATUS_MASK) != DISK_READY)
+        return FALSE;
+
+    disk->data0 = (unsigned int)p8rbuf;
+    status      = SYSCALL(WAITIO, DISK_READBLK | (0 << DISK_HEAD_SHIFT) | (0 << DISK_SECT_SHIFT), (int)disk, FALSE);
+    if ((status & DISK_STATUS_MASK) != DISK_READY)
+        return FALSE;
+
+    for (i = 0; i < DISK_BLOCK_SIZE; i++)
+        if (p8rbuf[i] != p8wbuf[i])
+            return FALSE;
+
+    return TRUE;
+}
+
+/* p8 -- write-back disk cache test, the block is read back while cached and after the sync,
+   the stats of the disk count the operations */
+void p8() {
+    dev_stats_t before, after; /* stats of disk 0 */
+    int         i;
+
+    print("p8 starts\n");
+
+    for (i = 0; i < DISK_BLOCK_SIZE; i++)
+        p8wbuf[i] = (char)i;
+
+    SYSCALL(GETDEVSTATS, DEV_REG_ADDR(IL_DISK, 0), 0, (int)&before);
+
+    if ((int)SYSCALL(DISKWRITE, 0, 0, (int)p8wbuf) == ERROR)
+        print("p8 disk 0 not installed, cache not tested\n");
+    else if (!p8read()) /* the cache holds the dirty block */
+        print("error: p8 cached block not read back\n");
+    else if ((int)SYSCALL(DISKSYNC, 0, 0, 0) != 0)
+        print("error: p8 disk sync failed\n");
+    else if (!p8read()) /* now it's read from the disk */
+        print("error: p8 synced block not read back\n");
+    /* the block has been written and read, with a seek at least */
+    else if ((int)SYSCALL(GETDEVSTATS, DEV_REG_ADDR(IL_DISK, 0), 0, (int)&after) != 0 ||
+             after.ops < before.ops + 3 || after.bytes < before.bytes + 2 * DISK_BLOCK_SIZE ||
+             after.busy_time <= before.busy_time)
+        print("error: p8 disk stats not updated\n");
+    else
+        print("p8 write, sync and read back of a disk block OK\n");
+
+    end_test();
+}
+
+/* p9 -- SEMOP restart test, the child blocks in the middle of a P(2) and is waken up twice */
+void p9() {
+    print("p9 starts\n");
+
+    /* the array is checked before applying the first operation */
+    if ((int)SYSCALL(SEMOP, (int)p9bad, 2, 0) != ERROR || p9sem1 != 1)
+        print("error: p9 invalid SEMOP not refused before applying it\n");
+
+    start_child(0, p9child, DEFAULT_PRIORITY);
+
+    /* the child takes p9sem1 and blocks on p9sem2 */
+    if ((int)SYSCALL(PASSERENTIMED, (int)&p9done, P9WAIT, 0) != TIMEOUT || p9sem1 != 0)
+        print("error: p9 SEMOP didn't block on its second operation\n");
+
+    /* each V hands off a unit, the child restarts from the P(2) and ends only after the second one */
+    SYSCALL(VERHOGEN, (int)&p9sem2, 0, 0);
+
+    if ((int)SYSCALL(PASSERENTIMED, (int)&p9done, P9WAIT, 0) != TIMEOUT)
+        print("error: p9 restarted SEMOP ended with a unit of its P(2)\n");
+
+    SYSCALL(VERHOGEN, (int)&p9sem2, 0, 0);
+    SYSCALL(PASSEREN, (int)&p9done, 0, 0);
+
+    if (p9result != 0 || p9sem1 != 0 || p9sem2 != 0)
+        print("error: p9 restarted SEMOP went wrong\n");
+    else
+        print("p9 SEMOP restarted after blocking OK\n");
+
+    end_test();
+}
+
+void p9child() {
+    p9result = SYSCALL(SEMOP, (int)p9ops, 2, 0);
+
+    SYSCALL(VERHOGEN, (int)&p9done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* p10 -- timed P test, nobody releases the semaphore once p10 has taken it */
+void p10() {
+    cpu_t now1, now2;
+    int   status;
+
+    print("p10 starts\n");
+
+    if ((int)SYSCALL(PASSERENTIMED, (int)&p10sem, P10WAIT, 0) != 0)
+        print("error: p10 free semaphore not taken\n");
+
+    if ((int)SYSCALL(PASSERENTIMED, (int)&p10sem, 0, 0) != TIMEOUT)
+        print("error: p10 timed P with no wait didn't return TIMEOUT\n");
+
+    now1   = getTODLO();
+    status = SYSCALL(PASSERENTIMED, (int)&p10sem, P10WAIT, 0);
+    now2   = getTODLO();
+
+    if (status != TIMEOUT)
+        print("error: p10 timed P didn't return TIMEOUT\n");
+    else if ((now2 - now1) < P10WAIT)
+        print("error: p10 timed P expired too early\n");
+    else {
+        /* the expired wait left the queue, so the V isn't handed off to it */
+        SYSCALL(VERHOGEN, (int)&p10sem, 0, 0);
+
+        if (p10sem != 1)
+            print("error: p10 semaphore still has a waiter after the timeout\n");
+        else
+            print("p10 timed P returned TIMEOUT OK\n");
+    }
+
+    end_test();
+}
+
+/* p11 -- priority inheritance test, seen through the order the owner of a mutex and a process
+   with a medium priority run in: first with the waiter that raised the owner killed, then not */
+void p11() {
+    print("p11 starts\n");
+
+#if defined(SCHED_FAIR) || defined(SCHED_STRIDE)
+    /* the CPU is shared by weight, the priority doesn't choose who runs first */
+    print("p11 priority inheritance not tested with this policy\n");
+#else
+    SYSCALL(SETPRIORITY, 0, P11TOP, FALSE);
+
+    if ((int)SYSCALL(SEMCTL, SEM_MUTEX, (int)&p11mutex, TRUE) != 0)
+        print("error: p11 can't turn the mutex mode on\n");
+
+    /* the owner loses the priority of a killed waiter, so the medium process runs first */
+    start_child(0, p11owner, DEFAULT_PRIORITY);
+    SYSCALL(PASSEREN, (int)&p11held, 0, 0);
+
+    p11waiterpid = start_child(1, p11waiter, P11PRIO);
+    SYSCALL(PASSERENTIMED, (int)&p11sleep, P11WAIT, 0);
+
+    if ((int)SYSCALL(VERHOGEN, (int)&p11mutex, 0, 0) != ERROR)
+        print("error: p11 released a mutex it doesn't own\n");
+
+    SYSCALL(TERMINATEPROCESS, (int)p11waiterpid, 0, 0);
+    p11midpid = start_child(2, p11mid, P11MID);
+    SYSCALL(VERHOGEN, (int)&p11hold, 0, 0);
+
+    SYSCALL(PASSEREN, (int)&p11done, 0, 0);
+    SYSCALL(PASSEREN, (int)&p11done, 0, 0);
+
+    if (p11first != p11midpid)
+        print("error: p11 inheritance not undone after the waiter was killed\n");
+
+    /* the owner raised by the waiter runs before the medium process, till it releases the mutex */
+    p11first = 0;
+    start_child(0, p11owner, DEFAULT_PRIORITY);
+    SYSCALL(PASSEREN, (int)&p11held, 0, 0);
+
+    start_child(1, p11waiter, P11PRIO);
+    SYSCALL(PASSERENTIMED, (int)&p11sleep, P11WAIT, 0);
+
+    p11midpid = start_child(2, p11mid, P11MID);
+    SYSCALL(VERHOGEN, (int)&p11hold, 0, 0);
+
+    SYSCALL(PASSEREN, (int)&p11done, 0, 0);
+    SYSCALL(PASSEREN, (int)&p11done, 0, 0);
+    SYSCALL(PASSEREN, (int)&p11done, 0, 0);
+
+    if (p11first == p11midpid)
+        print("error: p11 owner didn't inherit the waiter priority\n");
+    else
+        print("p11 priority inheritance and its undo OK\n");
+
+    SYSCALL(SEMCTL, SEM_MUTEX, (int)&p11mutex, FALSE);
+#endif
+
+    end_test();
+}
+
+/* records the first of p11's children that runs (the owner after releasing the mutex) */
+void p11record() {
+    pid_t pid;
+
+    SYSCALL(GETPID, (int)&pid, 0, 0);
+
+    if (p11first == 0)
+        p11first = pid;
+
+    SYSCALL(VERHOGEN, (int)&p11done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+void p11owner() {
+    SYSCALL(PASSEREN, (int)&p11mutex, 0, 0);
+    SYSCALL(VERHOGEN, (int)&p11held, 0, 0);
+    SYSCALL(PASSEREN, (int)&p11hold, 0, 0);
+
+    if ((int)SYSCALL(VERHOGEN, (int)&p11mutex, 0, 0) != 0)
+        print("error: p11 owner can't release its mutex\n");
+
+    p11record();
+}
+
+void p11waiter() {
+    SYSCALL(PASSEREN, (int)&p11mutex, 0, 0);
+    SYSCALL(VERHOGEN, (int)&p11mutex, 0, 0);
+    p11record();
+}
+
+void p11mid() {
+    p11record();
+}
+
+/* p12 -- EDF test, a job that needs more than its budget is throttled till the next release */
+void p12() {
+    cpu_t start, user, kernel, wallclock; /* CPU time used */
+    cpu_t now1, now2;                     /* times of day */
+    int   misses;
+
+    print("p12 starts\n");
+
+    if ((int)SYSCALL(EDFREGISTER, P12PERIOD, 2 * P12PERIOD, 0) != ERROR)
+        print("error: p12 admitted with a budget longer than the deadline\n");
+
+    now1 = getTODLO();
+    if ((int)SYSCALL(EDFREGISTER, P12PERIOD, P12BUDGET, 0) != 0) {
+        print("error: p12 not admitted as a real-time process\n");
+        end_test();
+    }
+
+    /* twice the budget can't be used before the next release */
+    SYSCALL(GETCPUTIME, (int)&start, (int)&kernel, (int)&wallclock);
+    do
+        SYSCALL(GETCPUTIME, (int)&user, (int)&kernel, (int)&wallclock);
+    while ((user - start) < 2 * P12BUDGET);
+    now2 = getTODLO();
+
+    /* the throttled jobs are unfinished when their deadline comes */
+    misses = SYSCALL(EDFWAIT, 0, 0, 0);
+
+    if ((now2 - now1) < P12PERIOD)
+        print("error: p12 not throttled till the next release\n");
+    else if (misses < 1)
+        print("error: p12 throttled jobs not counted as missed\n");
+    else if ((int)SYSCALL(EDFREGISTER, 0, 0, 0) != 0 || (int)SYSCALL(EDFWAIT, 0, 0, 0) != ERROR)
+        print("error: p12 not turned back to a normal process\n");
+    else
+        print("p12 real-time throttle and release OK\n");
+
+    end_test();
+}
+
+/* p13 -- group quota test, a group that needs more than its quota is throttled till the next period */
+void p13() {
+    cpu_t start, user, kernel, wallclock; /* CPU time used */
+    cpu_t now1, now2;                     /* times of day */
+
+    print("p13 starts\n");
+
+    if ((int)SYSCALL(SETQUOTA, 0, 2 * P13PERIOD, P13PERIOD) != ERROR)
+        print("error: p13 quota longer than the period accepted\n");
+
+    now1 = getTODLO();
+    if ((int)SYSCALL(SETQUOTA, 0, P13QUOTA, P13PERIOD) != 0) {
+        print("error: p13 can't get a group with a quota\n");
+        end_test();
+    }
+
+    /* twice the quota can't be used before the next period */
+    SYSCALL(GETCPUTIME, (int)&start, (int)&kernel, (int)&wallclock);
+    do
+        SYSCALL(GETCPUTIME, (int)&user, (int)&kernel, (int)&wallclock);
+    while ((user - start) < 2 * P13QUOTA);
+    now2 = getTODLO();
+
+    if ((now2 - now1) < P13PERIOD)
+        print("error: p13 group not throttled till the next period\n");
+    else if ((int)SYSCALL(SETQUOTA, 0, 0, 0) != 0)
+        print("error: p13 can't leave its group\n");
+    else
+        print("p13 group quota throttle OK\n");
+
+    end_test();
+}
+
+/* p14 -- directed yield test, to a ready process, to a blocked one and to a terminated one */
+void p14() {
+    pid_t ppid, childpid;
+
+    print("p14 starts\n");
+
+    /* CREATEPROCESS is a scheduling point, the child mustn't run before the YIELDTO */
+    SYSCALL(SETPRIORITY, 0, P14TOP, FALSE);
+    SYSCALL(GETPID, 0, (int)&ppid, 0);
+    childpid = start_child(0, p14child, DEFAULT_PRIORITY);
+
+    /* the child is ready, it must run before p14 goes on */
+    SYSCALL(YIELDTO, (int)childpid, 0, 0);
+
+    if (!p14ran)
+        print("error: p14 YIELDTO didn't run the ready process\n");
+    /* p1 is blocked waiting for p14 */
+    else if ((int)SYSCALL(YIELDTO, (int)ppid, 0, 0) != ERROR)
+        print("error: p14 YIELDTO to a blocked process didn't fail\n");
+    else {
+        /* the PCB of a killed process is free, it mustn't be dispatched */
+        SYSCALL(TERMINATEPROCESS, (int)childpid, 0, 0);
+
+        if ((int)SYSCALL(YIELDTO, (int)childpid, 0, 0) != ERROR)
+            print("error: p14 YIELDTO to a terminated process didn't fail\n");
+        else
+            print("p14 YIELDTO to ready, blocked and terminated processes OK\n");
+    }
+
+    end_test();
+}
+
+void p14child() {
+    p14ran = 1;
+    SYSCALL(PASSEREN, (int)&blktest, 0, 0);
+}
+
+/* p15 -- SETPRIORITY test, on a ready process and on one blocked on a semaphore sorted by priority */
+void p15() {
+    print("p15 starts\n");
+
+    /* CREATEPROCESS is a scheduling point, the children mustn't run before p15 blocks */
+    SYSCALL(SETPRIORITY, 0, P15TOP, FALSE);
+
+#if !defined(SCHED_FAIR) && !defined(SCHED_STRIDE)
+    /* of two ready children with the same priority the second one is raised, so it runs first */
+    p15child1pid = start_child(0, p15run, DEFAULT_PRIORITY);
+    p15child2pid = start_child(1, p15run, DEFAULT_PRIORITY);
+
+    if ((int)SYSCALL(SETPRIORITY, (int)p15child2pid, P15PRIO, FALSE) != 0)
+        print("error: p15 priority of a ready process not set\n");
+
+    SYSCALL(PASSEREN, (int)&p15done, 0, 0);
+    SYSCALL(PASSEREN, (int)&p15done, 0, 0);
+
+    if (p15first != p15child2pid)
+        print("error: p15 ready process not moved by its new priority\n");
+#else
+    /* the CPU is shared by weight, the priority doesn't choose who runs first */
+    print("p15 SETPRIORITY on a ready process not tested with this policy\n");
+#endif
+
+    /* the second child blocked on the semaphore is raised, so it's waken up first */
+    SYSCALL(SEMCTL, SEM_WAKEPOLICY, (int)&p15sem, SEM_WAKE_PRIORITY);
+    p15first = 0;
+    p15child1pid = start_child(0, p15child, DEFAULT_PRIORITY);
+    p15child2pid = start_child(1, p15child, DEFAULT_PRIORITY);
+
+    /* while p15 sleeps its children run, and block on the semaphore in order of creation */
+    SYSCALL(PASSERENTIMED, (int)&p15sleep, P15WAIT, 0);
+
+    if ((int)SYSCALL(SETPRIORITY, (int)p15child2pid, P15PRIO, FALSE) != 0)
+        print("error: p15 priority of a blocked process not set\n");
+
+    SYSCALL(VERHOGEN, (int)&p15sem, 0, 0);
+    SYSCALL(PASSEREN, (int)&p15done, 0, 0);
+
+    if (p15first != p15child2pid)
+        print("error: p15 blocked process not moved by its new priority\n");
+    else
+        print("p15 SETPRIORITY on ready and blocked processes OK\n");
+
+    SYSCALL(VERHOGEN, (int)&p15sem, 0, 0);
+    SYSCALL(PASSEREN, (int)&p15done, 0, 0);
+    SYSCALL(SEMCTL, SEM_WAKEPOLICY, (int)&p15sem, SEM_WAKE_FIFO);
+
+    end_test();
+}
+
+/* records the first child that runs and ends */
+void p15run() {
+    pid_t pid;
+
+    SYSCALL(GETPID, (int)&pid, 0, 0);
+
+    if (p15first == 0)
+        p15first = pid;
+
+    SYSCALL(VERHOGEN, (int)&p15done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+void p15child() {
+    SYSCALL(PASSEREN, (int)&p15sem, 0, 0);
+    p15run();
+}
+
+/* p16 -- READLINE test, it needs a line typed on terminal 0 (else it's skipped) */
+void p16() {
+    devregtr *base = (devregtr *)DEV_REG_ADDR(IL_TERMINAL, 0);
+    int       len  = 0;
+
+    print("p16 starts, type a line on terminal 0\n");
+
+    if ((int)SYSCALL(READLINE, (int)p16line, 0, 0) != ERROR)
+        print("error: p16 READLINE with no room in the buffer accepted\n");
+
+    start_child(0, p16reader, DEFAULT_PRIORITY);
+
+    /* the reader is blocked (using no CPU) till the newline, if none comes it's killed with p16 */
+    if ((int)SYSCALL(PASSERENTIMED, (int)&p16done, P16WAIT, 0) == TIMEOUT)
+        print("p16 no line typed, READLINE not tested\n");
+    else {
+        while (p16line[len] != '\0')
+            len++;
+
+        if (p16len != len)
+            print("error: p16 READLINE returned a wrong length\n");
+        else if ((int)SYSCALL(WAITIO, CMD_RECEIVE, (int)base, TRUE) != ERROR)
+            print("error: p16 receiver in use by READLINE given to WAITIO\n");
+        else {
+            print("p16 READLINE got the line: ");
+            print(p16line);
+            print("\n");
+        }
+    }
+
+    end_test();
+}
+
+void p16reader() {
+    p16len = SYSCALL(READLINE, (int)p16line, P16LINELEN, 0);
+
+    SYSCALL(VERHOGEN, (int)&p16done, 0, 0);
+    SYSCALL(PASSEREN, (int)&blktest, 0, 0);
+}
+
+/* p17 -- BARRIERWAIT test (with a waiter killed before the opening) and SEMBROADCAST test */
+void p17() {
+    pid_t killedpid;
+    int   status;
+
+    print("p17 starts\n");
+
+    /* a waiter killed before the opening mustn't count as arrived */
+    killedpid = start_child(0, p17waiter, DEFAULT_PRIORITY);
+    SYSCALL(PASSERENTIMED, (int)&p17sleep, P17WAIT, 0);
+    SYSCALL(TERMINATEPROCESS, (int)killedpid, 0, 0);
+
+    start_child(1, p17waiter, DEFAULT_PRIORITY);
+    start_child(2, p17waiter, DEFAULT_PRIORITY);
+    SYSCALL(PASSERENTIMED, (int)&p17sleep, P17WAIT, 0);
+
+    if (p17passed != 0) {
+        print("error: p17 barrier opened before all the parties arrived\n");
+        end_test();
+    }
+
+    /* p17 is the last one, it opens the barrier */
+    if ((int)SYSCALL(BARRIERWAIT, (int)&p17bar, 0, 0) != 1)
+        print("error: p17 BARRIERWAIT didn't return 1 to the last process\n");
+
+    SYSCALL(PASSEREN, (int)&p17done, 0, 0);
+    SYSCALL(PASSEREN, (int)&p17done, 0, 0);
+
+    if (p17passed != 2)
+        print("error: p17 BARRIERWAIT didn't return 0 to the waiters\n");
+    else
+        print("p17 BARRIERWAIT OK\n");
+
+    /* the blocked processes are all waken up, and the value of the semaphore doesn't change */
+    p17passed = 0;
+    start_child(0, p17bcast, DEFAULT_PRIORITY);
+    start_child(3, p17bcast, DEFAULT_PRIORITY);
+    SYSCALL(PASSERENTIMED, (int)&p17sleep, P17WAIT, 0);
+
+    if ((status = SYSCALL(SEMBROADCAST, (int)&p17sem, 0, 0)) != 2)
+        print("error: p17 SEMBROADCAST didn't return the number of waiters\n");
+
+    SYSCALL(PASSEREN, (int)&p17done, 0, 0);
+    SYSCALL(PASSEREN, (int)&p17done, 0, 0);
+
+    if (p17passed != 2 || p17sem != 0)
+        print("error: p17 SEMBROADCAST didn't wake up all the waiters\n");
+    else if ((int)SYSCALL(SEMBROADCAST, (int)&p17sem, 0, 0) != 0)
+        print("error: p17 SEMBROADCAST without waiters didn't return 0\n");
+    else if (status == 2)
+        print("p17 SEMBROADCAST OK\n");
+
+    end_test();
+}
+
+void p17waiter() {
+    if ((int)SYSCALL(BARRIERWAIT, (int)&p17bar, 0, 0) == 0)
+        p17passed++;
+
+    SYSCALL(VERHOGEN, (int)&p17done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+void p17bcast() {
+    SYSCALL(PASSEREN, (int)&p17sem, 0, 0);
+    p17passed++;
+
+    SYSCALL(VERHOGEN, (int)&p17done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* p18 -- RWLOCK ownership test: only a holder can unlock, and a killed holder releases the lock */
+void p18() {
+    pid_t readerpid;
+
+    print("p18 starts\n");
+
+    if ((int)SYSCALL(RWLOCK, (int)&p18lock, RW_WRITE_LOCK, 0) != 0)
+        print("error: p18 free lock not taken\n");
+
+    if ((int)SYSCALL(RWLOCK, (int)&p18lock, RW_READ_LOCK, 0) != ERROR)
+        print("error: p18 lock taken twice by the same process\n");
+
+    /* the child can't unlock the lock held by p18, it waits for it as a reader */
+    readerpid = start_child(0, p18reader, DEFAULT_PRIORITY);
+    SYSCALL(PASSERENTIMED, (int)&p18sleep, P18WAIT, 0);
+
+    if (p18unlock != ERROR || p18read)
+        print("error: p18 lock released by a process not holding it\n");
+
+    SYSCALL(RWLOCK, (int)&p18lock, RW_WRITE_UNLOCK, 0);
+    SYSCALL(PASSEREN, (int)&p18done, 0, 0);
+
+    if ((int)SYSCALL(RWLOCK, (int)&p18lock, RW_READ_UNLOCK, 0) != ERROR)
+        print("error: p18 read lock released by a process not holding it\n");
+
+    /* the reader is killed holding the lock, so a writer gets it */
+    SYSCALL(TERMINATEPROCESS, (int)readerpid, 0, 0);
+    start_child(1, p18writer, DEFAULT_PRIORITY);
+
+    if ((int)SYSCALL(PASSERENTIMED, (int)&p18done, P18WAIT, 0) == TIMEOUT)
+        print("error: p18 lock not released by a killed holder\n");
+    else
+        print("p18 RWLOCK ownership OK\n");
+
+    end_test();
+}
+
+void p18reader() {
+    p18unlock = SYSCALL(RWLOCK, (int)&p18lock, RW_WRITE_UNLOCK, 0);
+
+    SYSCALL(RWLOCK, (int)&p18lock, RW_READ_LOCK, 0);
+    p18read = 1;
+
+    SYSCALL(VERHOGEN, (int)&p18done, 0, 0);
+    SYSCALL(PASSEREN, (int)&blktest, 0, 0);
+}
+
+void p18writer() {
+    SYSCALL(RWLOCK, (int)&p18lock, RW_WRITE_LOCK, 0);
+    SYSCALL(RWLOCK, (int)&p18lock, RW_WRITE_UNLOCK, 0);
+
+    SYSCALL(VERHOGEN, (int)&p18done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* p19 -- TERMWRITE test, only the first line of p19line must appear on terminal 0 */
+void p19() {
+    int status;
+
+    print("p19 starts\n");
+
+    if ((int)SYSCALL(TERMWRITE, (int)p19line, 0, 0) != 0)
+        print("error: p19 TERMWRITE of 0 chars didn't return 0\n");
+
+    if ((int)SYSCALL(TERMWRITE, (int)p19line, P19LEN, DEV_PER_INT) != ERROR)
+        print("error: p19 TERMWRITE on a terminal that doesn't exist didn't fail\n");
+
+    /* the string is written between the ones of print */
+    SYSCALL(PASSEREN, (int)&term_mut, 0, 0);
+    status = SYSCALL(TERMWRITE, (int)p19line, P19LEN, 0);
+    SYSCALL(VERHOGEN, (int)&term_mut, 0, 0);
+
+    if (status != P19LEN)
+        print("error: p19 TERMWRITE didn't return the number of chars written\n");
+    else
+        print("p19 TERMWRITE OK\n");
+
+    end_test();
+}
+
+#ifdef EVENT_LOG
+/* reads block P20BLOCK of disk 0 (on the first cylinder and head) in p20log with WAITIO */
+int p20read() {
+    dtpreg_t *disk = (dtpreg_t *)DEV_REG_ADDR(IL_DISK, 0);
+    int       status;
+
+    status = SYSCALL(WAITIO, DISK_SEEKCYL | (0 << DISK_CYL_SHIFT), (int)disk, FALSE);
+    if ((status & DISK_STATUS_MASK) != DISK_READY)
+        return FALSE;
+
+    disk->data0 = (unsigned int)p20log;
+    status      = SYSCALL(WAITIO, DISK_READBLK | (0 << DISK_HEAD_SHIFT) | (P20BLOCK << DISK_SECT_SHIFT), (int)disk, FALSE);
+
+    return ((status & DISK_STATUS_MASK) == DISK_READY);
+}
+
+/* drains a block of the log on disk 0 and reads it back */
+void p20drain() {
+    dtpreg_t *disk = (dtpreg_t *)DEV_REG_ADDR(IL_DISK, 0);
+    int       i, yields;
+
+    if ((int)SYSCALL(EVLOGDRAIN, DEV_PER_INT, P20BLOCK, 1) != ERROR ||
+        (int)SYSCALL(EVLOGDRAIN, 0, P20BLOCK, 0) != ERROR)
+        print("error: p20 EVLOGDRAIN on a wrong area didn't fail\n");
+
+    if ((disk->status & DISK_STATUS_MASK) == DVC_NOT_INSTALLED) {
+        print("p20 disk 0 not installed, drain not tested\n");
+        return;
+    }
+
+    /* each syscall is logged, so the whole ring is filled at least once */
+    SYSCALL(EVLOGDRAIN, 0, P20BLOCK, 1);
+    for (i = 0; i < 2 * EVLOG_BLOCK_RECORDS; i++)
+        SYSCALL(YIELD, 0, 0, 0);
+    SYSCALL(EVLOGDRAIN, -1, 0, 0);
+
+    if ((int)SYSCALL(DISKSYNC, 0, 0, 0) != 0 || !p20read()) {
+        print("error: p20 drained block not read back\n");
+        return;
+    }
+
+    /* the block is full of valid records, some of them are p20's yields */
+    for (i = 0, yields = 0; i < EVLOG_BLOCK_RECORDS; i++) {
+        if (p20log[i].id == EV_NONE || p20log[i].id >= EV_NUM)
+            break;
+
+        yields += (p20log[i].id == EV_SYSCALL && p20log[i].arg[0] == YIELD);
+    }
+
+    if (i < EVLOG_BLOCK_RECORDS || yields == 0)
+        print("error: p20 drained block isn't a block of the log\n");
+    else
+        print("p20 EVLOGDRAIN OK\n");
+}
+#endif
+
+/* p20 -- EVLOGDRAIN test, a block of the log is drained on disk 0 and read back */
+void p20() {
+    print("p20 starts\n");
+
+#ifdef EVENT_LOG
+    p20drain();
+#else
+    if ((int)SYSCALL(EVLOGDRAIN, 0, P20BLOCK, 1) != ERROR)
+        print("error: p20 EVLOGDRAIN with the event log compiled out didn't fail\n");
+    else
+        print("p20 event log compiled out, EVLOGDRAIN refused OK\n");
+#endif
+
+    end_test();
+}
+
+/* p21 -- user semaphores test: fast paths, slow paths and restartable sequences rolled back */
+void p21() {
+    print("p21 starts\n");
+
+    if (usem_register() != 0) {
+        print("error: p21 fast paths not registered as restartable sequences\n");
+        end_test();
+    }
+
+    /* the fast paths change the value without trapping */
+    usem_p(&p21mutex);
+    usem_v(&p21mutex);
+    if (p21mutex.value != 1 || p21mutex.waiters != 0)
+        print("error: p21 fast paths of P and V went wrong\n");
+
+    /* slow paths: the child waits in the kernel and the V wakes it up leaving the value unchanged */
+    start_child(0, p21waiter, DEFAULT_PRIORITY);
+    if ((int)SYSCALL(PASSERENTIMED, (int)&p21done, P21WAIT, 0) != TIMEOUT || p21sem.waiters != 1)
+        print("error: p21 P on a user semaphore at 0 didn't block\n");
+
+    usem_v(&p21sem);
+    if ((int)SYSCALL(PASSERENTIMED, (int)&p21done, P21WAIT, 0) == TIMEOUT || p21sem.value != 0 || p21sem.waiters != 0)
+        print("error: p21 V didn't hand the user semaphore to the waiter\n");
+
+    /* the workers are preempted at random points, in the middle of the fast paths too (rolled back) */
+    start_child(1, p21worker, DEFAULT_PRIORITY);
+    start_child(2, p21worker, DEFAULT_PRIORITY);
+    SYSCALL(PASSEREN, (int)&p21done, 0, 0);
+    SYSCALL(PASSEREN, (int)&p21done, 0, 0);
+
+    if (p21count != 2 * P21LOOPS || p21mutex.value != 1 || p21mutex.waiters != 0)
+        print("error: p21 user semaphore didn't keep the mutual exclusion\n");
+    else
+        print("p21 user semaphores OK\n");
+
+    end_test();
+}
+
+void p21worker() {
+    int i, count;
+
+    for (i = 0; i < P21LOOPS; i++) {
+        usem_p(&p21mutex);
+        count = p21count;
+        p21count = count + 1;
+        usem_v(&p21mutex);
+    }
+
+    SYSCALL(VERHOGEN, (int)&p21done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+void p21waiter() {
+    usem_p(&p21sem);
+
+    SYSCALL(VERHOGEN, (int)&p21done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* p22 -- SEMWAITANY test, it must return the index of the semaphore taken */
+void p22() {
+    print("p22 starts\n");
+
+    if ((int)SYSCALL(SEMWAITANY, (int)p22sems, 0, 0) != ERROR)
+        print("error: p22 SEMWAITANY on no semaphores didn't fail\n");
+
+    /* available semaphores are taken right away, the one with the lowest index first */
+    p22sem[1] = p22sem[2] = 1;
+    if ((int)SYSCALL(SEMWAITANY, (int)p22sems, 3, 0) != 1 || p22sem[1] != 0 ||
+        (int)SYSCALL(SEMWAITANY, (int)p22sems, 3, 0) != 2 || p22sem[2] != 0)
+        print("error: p22 SEMWAITANY didn't take the first available semaphore\n");
+
+    /* the child is waken up by the V on the second one, and leaves the queue of the others */
+    start_child(0, p22child, DEFAULT_PRIORITY);
+    if ((int)SYSCALL(PASSERENTIMED, (int)&p22done, P22WAIT, 0) != TIMEOUT)
+        print("error: p22 SEMWAITANY didn't block\n");
+
+    SYSCALL(VERHOGEN, (int)&p22sem[1], 0, 0);
+    SYSCALL(PASSEREN, (int)&p22done, 0, 0);
+    SYSCALL(VERHOGEN, (int)&p22sem[0], 0, 0);
+
+    if (p22index != 1)
+        print("error: p22 SEMWAITANY didn't return the index of the semaphore that fired\n");
+    else if (p22sem[0] != 1 || p22sem[1] != 0)
+        print("error: p22 process waken up still waiting on the other semaphores\n");
+    else
+        print("p22 SEMWAITANY OK\n");
+
+    end_test();
+}
+
+void p22child() {
+    p22index = SYSCALL(SEMWAITANY, (int)p22sems, 3, 0);
+
+    SYSCALL(VERHOGEN, (int)&p22done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* p23 -- SEMSTATS test, the semaphore with the longer wait must be ranked before the other */
+void p23() {
+    int n, i, shortpos = -1, longpos = -1, sorted = TRUE;
+
+    print("p23 starts\n");
+
+    /* the stats are kept with the attributes of the semaphores */
+    SYSCALL(SEMCTL, SEM_WAKEPOLICY, (int)&p23short, SEM_WAKE_PRIORITY);
+    SYSCALL(SEMCTL, SEM_WAKEPOLICY, (int)&p23long, SEM_WAKE_PRIORITY);
+
+    start_child(0, p23child, DEFAULT_PRIORITY);
+    SYSCALL(PASSERENTIMED, (int)&p23sleep, P23WAIT, 0);
+    SYSCALL(VERHOGEN, (int)&p23short, 0, 0);
+    SYSCALL(PASSERENTIMED, (int)&p23sleep, 10 * P23WAIT, 0);
+    SYSCALL(VERHOGEN, (int)&p23long, 0, 0);
+    SYSCALL(PASSEREN, (int)&p23done, 0, 0);
+
+    if ((int)SYSCALL(SEMSTATS, 0, P23STATS, 0) != ERROR)
+        print("error: p23 SEMSTATS without an array didn't fail\n");
+
+    n = SYSCALL(SEMSTATS, (int)p23stats, P23STATS, 0);
+
+    for (i = 0; i < n; i++) {
+        if (p23stats[i].key == &p23short)
+            shortpos = i;
+        if (p23stats[i].key == &p23long)
+            longpos = i;
+
+        sorted = sorted && (i == 0 || p23stats[i].total_wait <= p23stats[i - 1].total_wait);
+    }
+
+    if (shortpos < 0 || longpos < 0 || p23stats[shortpos].blocked != 1 || p23stats[longpos].blocked != 1)
+        print("error: p23 SEMSTATS didn't count the waits\n");
+    else if (!sorted || longpos > shortpos || p23stats[longpos].max_wait < 5 * P23WAIT)
+        print("error: p23 SEMSTATS ranking not by total wait time\n");
+    else
+        print("p23 SEMSTATS ranking OK\n");
+
+    SYSCALL(SEMCTL, SEM_WAKEPOLICY, (int)&p23short, SEM_WAKE_FIFO);
+    SYSCALL(SEMCTL, SEM_WAKEPOLICY, (int)&p23long, SEM_WAKE_FIFO);
+
+    end_test();
+}
+
+void p23child() {
+    SYSCALL(PASSEREN, (int)&p23short, 0, 0);
+    SYSCALL(PASSEREN, (int)&p23long, 0, 0);
+
+    SYSCALL(VERHOGEN, (int)&p23done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+#if !defined(SCHED_MLFQ) && !defined(SCHED_FAIR) && !defined(SCHED_STRIDE)
+/* runs a CPU bound and an I/O bound child, and checks the times the I/O bound one runs at */
+void p24slice() {
+    dtpreg_t *disk = (dtpreg_t *)DEV_REG_ADDR(IL_DISK, 0);
+    int       i;
+
+    if ((disk->status & DISK_STATUS_MASK) == DVC_NOT_INSTALLED) {
+        print("p24 disk 0 not installed, time slice after a device interrupt not tested\n");
+        return;
+    }
+
+    SYSCALL(SETPRIORITY, 0, P24TOP, FALSE);
+    start_child(0, p24spin, DEFAULT_PRIORITY);
+    start_child(1, p24io, DEFAULT_PRIORITY);
+    SYSCALL(PASSEREN, (int)&p24done, 0, 0);
+    SYSCALL(PASSEREN, (int)&p24done, 0, 0);
+
+    /* the I/O bound child, waken up by the interrupt, waits for the end of the spinner's slice */
+    for (i = 1; i < P24TURNS; i++)
+        if (p24tod[i] - p24tod[i - 1] < TIME_SLICE / 2)
+            break;
+
+    if (i < P24TURNS)
+        print("error: p24 time slice ended by a device interrupt\n");
+    else
+        print("p24 time slice kept after a device interrupt OK\n");
+}
+#endif
+
+/* p24 -- device interrupt test, the running process keeps its time slice when a device interrupts */
+void p24() {
+    print("p24 starts\n");
+
+#if !defined(SCHED_MLFQ) && !defined(SCHED_FAIR) && !defined(SCHED_STRIDE)
+    p24slice();
+#else
+    /* an I/O bound process goes before a CPU bound one, it preempts it when waken up */
+    print("p24 time slice after a device interrupt not tested with this policy\n");
+#endif
+
+    end_test();
+}
+
+void p24spin() {
+    while (!p24stop)
+        ;
+
+    SYSCALL(VERHOGEN, (int)&p24done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+void p24io() {
+    dtpreg_t *disk = (dtpreg_t *)DEV_REG_ADDR(IL_DISK, 0);
+    int       i;
+
+    for (i = 0; i < P24TURNS; i++) {
+        p24tod[i] = getTODLO();
+        SYSCALL(WAITIO, DISK_SEEKCYL | (0 << DISK_CYL_SHIFT), (int)disk, FALSE);
+    }
+
+    p24stop = 1;
+    SYSCALL(VERHOGEN, (int)&p24done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+/* p25 -- preemption test, a process waken up by a V runs before the lower priority caller goes on */
+void p25() {
+    print("p25 starts\n");
+
+#if PREEMPT_MARGIN <= 0 || defined(SCHED_FAIR) || defined(SCHED_STRIDE)
+    /* the CPU is shared by weight (or preemption is disabled), the priority doesn't preempt */
+    print("p25 preemption on wake up not tested with this configuration\n");
+#else
+    SYSCALL(SETPRIORITY, 0, P25TOP, FALSE);
+    start_child(0, p25high, P25PRIO);
+    start_child(1, p25low, DEFAULT_PRIORITY);
+    SYSCALL(PASSEREN, (int)&p25done, 0, 0);
+    SYSCALL(PASSEREN, (int)&p25done, 0, 0);
+
+    if (p25seen != 0)
+        print("error: p25 waken up process didn't preempt the lower priority one\n");
+    else
+        print("p25 preemption on a higher priority wake up OK\n");
+#endif
+
+    end_test();
+}
+
+void p25high() {
+    SYSCALL(PASSEREN, (int)&p25sem, 0, 0);
+    p25seen = p25after;
+
+    SYSCALL(VERHOGEN, (int)&p25done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+void p25low() {
+    SYSCALL(VERHOGEN, (int)&p25sem, 0, 0);
+    p25after = 1;
+
+    SYSCALL(VERHOGEN, (int)&p25done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
 #include "exception_hndlr/interrupt.h"
 #include "exception_hndlr/syscall_bp.h"
 #include "exception_hndlr/trap.h"
@@ -644,6 +1759,8 @@ void p7leaf() {
 #include "process/scheduler.h"
 #include "process/pcb.h"
 #include "generics/utils.h"
+#include "devices/disk_utils.h"
+#include "devices/device_utils.h"
 
 #ifdef TARGET_UMPS
 #define INIT_OPTION { ENABLE_INTERRUPT, KERNEL_MD_ON, ALL_INTRRPT_ENABLED, VIRT_MEM_OFF, PLT_DISABLED }
@@ -652,6 +1769,14 @@ void p7leaf() {
 #define INIT_OPTION { ENABLE_INTERRUPT, KERNEL_MD_ON, VIRT_MEM_OFF, TIMER_ENABLED }    
 #endif
 
+#ifdef STRIDE_BENCH
+// The init process runs the stride scheduling benchmark instead of the test
+void stride_bench(void);
+#define INIT_ENTRY stride_bench
+#else
+#define INIT_ENTRY test
+#endif
+
 // BiKayaOS entry point
 int main(void) {
     print_debug_terminal("Welcome to phase 2 of BiKayaOS\n\0");
@@ -667,6 +1792,10 @@ int main(void) {
     scheduler_init();
     print_debug_terminal("Initialized ASL, PCB, ready_queue and scheduler\n\0");
 
+    init_devTable();
+    init_diskCache();
+    print_debug_terminal("Initialized the device table and the disk write-back cache\n\0");
+
     // Init process allocation and execution priiviledge setup
     pcb_t* initProcess = allocPcb();
     process_option opt = INIT_OPTION;
@@ -676,7 +1805,7 @@ int main(void) {
 
     setStatusReg(&initProcess->p_s, &opt);
     setStackP(&initProcess->p_s, (memaddr)(_RAMTOP - RAM_FRAMESIZE));
-    setPC(&initProcess->p_s, (memaddr)test);
+    setPC(&initProcess->p_s, (memaddr)INIT_ENTRY);
     
     initProcess->priority = 1;
     scheduler_add(initProcess);
@@ -1,16 +1,35 @@
 #include "../include/system_const.h"
 #include "../include/types_bikaya.h"
 #include "../include/listx.h"
+#include "../generics/utils.h"
+#include "timer.h"
+#include "mutex.h"
 #include "asl.h"
 
-HIDDEN semd_t semdTmp_arr[MAXPROC];
+HIDDEN semd_t semdTmp_arr[MAXSEMD];
 HIDDEN LIST_HEAD(semdFree_list); //Free semaphores list
 HIDDEN LIST_HEAD(semdActive_list); // Active semaphore list
+HIDDEN semattr_t semAttr_table[MAXSEMATTR]; // Semaphores attributes, a free entry has a NULL key
 
 
+/*
+    Auxiliary function that adds the contention stats in src to the ones in dst
+
+    dst: the stats to be updated
+    src: the stats to be added
+    return: void
+*/
+HIDDEN void addSemStats(semstats_t *dst, semstats_t *src) {
+    dst->blocked += src->blocked;
+    dst->total_wait += src->total_wait;
+    dst->max_wait = (src->max_wait > dst->max_wait) ? src->max_wait : dst->max_wait;
+    dst->max_queue = (src->max_queue > dst->max_queue) ? src->max_queue : dst->max_queue;
+}
+
 /*
     Auxiliary function to remove a semaphore with an empty process queue from 
-    the active semaphore list, it removes it only if empty
+    the active semaphore list, it removes it only if empty. Its contention stats
+    are moved in the attributes table, so that they outlive the semd.
     
     semd: the semaphore that as to be removed if empty
     return: void
@@ -19,7 +38,134 @@ HIDDEN void rmvEmptySemd(semd_t* semd) {
     if (list_empty(&semd->s_procQ)) {
         list_del(&semd->s_next); 
         list_add_tail(&semd->s_next, &semdFree_list);
+
+        // The entry is allocated only now, and once for each semaphore while it's kept in the table
+        semattr_t *attr = (semd->s_attr != NULL) ? semd->s_attr : getSemAttr(semd->s_key, TRUE);
+        (attr != NULL) ? addSemStats(&attr->stats, &semd->s_stats) : 0;
+        semd->s_attr = NULL;
+    }
+}
+
+/*
+    Auxiliary function that links a wait node in a priority ordered semaphore queue, after
+    the last node of its priority bucket (the bucket of the process priority)
+
+    semd: the semaphore descriptor
+    w: the wait node of the blocked PCB
+    return: void
+*/
+HIDDEN void semdInsertSorted(semd_t *semd, semwait_t *w) {
+    int priority = w->w_proc->priority;
+
+    // Negative priorities share the first bucket and the highest ones the last
+    u_int bucket = (priority <= 0) ? 0 : (priority >= SEM_PRIO_BUCKETS) ? SEM_PRIO_BUCKETS - 1 : priority;
+    struct list_head *after = &semd->s_procQ;
+
+    // After the last node with the same priority or, if none, the ones with the nearest higher priority
+    for (u_int b = bucket; b < SEM_PRIO_BUCKETS; b++)
+        if (semd->s_tail[b] != NULL) {
+            after = semd->s_tail[b];
+            break;
+        }
+
+    list_add(&w->w_next, after);
+    w->w_bucket = bucket;
+    semd->s_tail[bucket] = &w->w_next;
+}
+
+/*
+    Auxiliary function that adds a wait node to the semaphore queue following its wake policy:
+    in FIFO order (the default) or in priority order. In the latter the queue is kept sorted
+    by priority bucket, and the tail of each bucket lets the node be added without scanning.
+
+    semd: the semaphore descriptor
+    w: the wait node of the blocked PCB
+    return: void
+*/
+HIDDEN void semdEnqueue(semd_t *semd, semwait_t *w) {
+    semattr_t *attr = semd->s_attr;
+    w->w_semd = semd;
+    w->w_since = TOD_LO;
+    semd->s_len++;
+
+    semd->s_stats.blocked++;
+    semd->s_stats.max_queue = (semd->s_len > semd->s_stats.max_queue) ? semd->s_len : semd->s_stats.max_queue;
+
+    if (attr == NULL || !(attr->flags & SEMATTR_PRIORITY)) {
+        w->w_bucket = SEM_PRIO_BUCKETS;
+        list_add_tail(&w->w_next, &semd->s_procQ);
+        return ;
+    }
+
+    semdInsertSorted(semd, w);
+}
+
+/*
+    Auxiliary function that unlinks a wait node from its semaphore queue, if the node was
+    the last of its priority bucket the one before it becomes the last (if in the same bucket)
+
+    w: the wait node to be unlinked
+    return: void
+*/
+HIDDEN void semdDetach(semwait_t *w) {
+    semd_t *semd = w->w_semd;
+    u_int bucket = w->w_bucket;
+
+    if (bucket < SEM_PRIO_BUCKETS && semd->s_tail[bucket] == &w->w_next) {
+        struct list_head *prev = w->w_next.prev;
+        u_int same_bucket = (prev != &semd->s_procQ && container_of(prev, semwait_t, w_next)->w_bucket == bucket);
+
+        semd->s_tail[bucket] = same_bucket ? prev : NULL;
+    }
+
+    list_del(&w->w_next);
+}
+
+/*
+    Auxiliary function that removes a wait node from its semaphore queue in constant time.
+    The time spent in the queue is added to the semaphore stats, and the semd is freed if
+    its queue becomes empty.
+
+    w: the wait node to be removed
+    return: void
+*/
+HIDDEN void semdUnlink(semwait_t *w) {
+    semd_t *semd = w->w_semd;
+    u_int wait = TOD_LO - w->w_since;
+
+    semd->s_stats.total_wait += wait;
+    semd->s_stats.max_wait = (wait > semd->s_stats.max_wait) ? wait : semd->s_stats.max_wait;
+
+    semdDetach(w);
+    w->w_semd = NULL;
+    semd->s_len--;
+    rmvEmptySemd(semd);
+}
+
+/*
+    Auxiliary function that removes the PCB from all the semaphore queues where it's waiting.
+    A timed wait is cancelled as well, the process isn't waiting anymore. The owners of the
+    mutexes it was waiting on could have inherited its priority, so it's recomputed.
+
+    p: the blocked PCB
+    return: void
+*/
+HIDDEN void unlinkWaits(pcb_t *p) {
+    pcb_t *owners[SEMWAIT_MAX];
+    u_int nwait = p->p_nwait;
+
+    for (u_int i = 0; i < nwait; i++) {
+        semattr_t *attr = p->p_wait[i].w_semd->s_attr;
+        owners[i] = (attr != NULL && (attr->flags & SEMATTR_MUTEX)) ? attr->owner : NULL;
+        semdUnlink(&p->p_wait[i]);
     }
+
+    p->p_nwait = 0;
+    p->p_semkey = NULL;
+    timer_cancel(p);
+
+    for (u_int i = 0; i < nwait; i++)
+        mutex_waiter_left(owners[i]);
 }
 
 /*
@@ -53,10 +199,14 @@ unsigned int emptyASL() {
 */
 void initASL(void) {
 
-    for(u_int i = 0; i < MAXPROC ; i++) {
+    for(u_int i = 0; i < MAXSEMD ; i++) {
         INIT_LIST_HEAD(&semdTmp_arr[i].s_procQ); //Initialize s_procQ to empty list
+        wipe_Memory(semdTmp_arr[i].s_tail, sizeof(semdTmp_arr[i].s_tail));
+        semdTmp_arr[i].s_attr = NULL;
         list_add_tail(&semdTmp_arr[i].s_next, &semdFree_list);
     } 
+
+    wipe_Memory(semAttr_table, sizeof(semattr_t) * MAXSEMATTR);
 }
 
 /*
@@ -68,34 +218,55 @@ void initASL(void) {
     return: 0 on success, 1 on fail
 */
 int insertBlocked(int *key, pcb_t* p) {
-    semd_t *tmp = getSemd(key); //Find the semd through his own key
-    
-    if (tmp == NULL) {
-        if (! list_empty(&semdFree_list)) {
+    return (insertBlockedAny(&key, 1, p));
+}
+
+/*
+    Inserts the given PCB p in the queues of all the given semaphores at once (wait-any),
+    using one of its wait nodes for each. The semd are allocated as in insertBlocked, if
+    one isn't avaiable the PCB is removed from the queues where it has been already added.
+
+    keys: the keys of the semaphores
+    n: the number of semaphores (SEMWAIT_MAX at most)
+    p: the PCB desired to be added
+    return: 0 on success, 1 on fail
+*/
+int insertBlockedAny(int *keys[], u_int n, pcb_t *p) {
+    if (n == 0 || n > SEMWAIT_MAX)
+        return (TRUE);
+
+    for (u_int i = 0; i < n; i++) {
+        semd_t *tmp = getSemd(keys[i]); //Find the semd through his own key
+
+        if (tmp == NULL) {
+            if (list_empty(&semdFree_list)) {
+                unlinkWaits(p);
+                return (TRUE);
+            }
+
             //Gets a new semaphore and adds it to the ASL (Active Semaphor List)
             tmp = container_of(list_next(&semdFree_list), semd_t, s_next); //Obtain the first semd in the free queue
             list_del(&tmp->s_next);
             list_add_tail(&tmp->s_next, &semdActive_list);
-            
-            //Adds the PCB p to the semaphore process queue and sets the key
-            list_add_tail(&p->p_next, &tmp->s_procQ);
-            p->p_semkey = key;
-            tmp->s_key = key;
+            tmp->s_key = keys[i];
+            tmp->s_attr = getSemAttr(keys[i], FALSE);
+            wipe_Memory(&tmp->s_stats, sizeof(semstats_t));
+        }
 
-            return (FALSE);
-        } 
-        else
-            return (TRUE);
+        //Adds the PCB p to the semaphore process queue (following the wake policy)
+        p->p_wait[i].w_proc = p;
+        semdEnqueue(tmp, &p->p_wait[i]);
+        p->p_nwait = i + 1;
     }
-    p->p_semkey = tmp->s_key;
-    list_add_tail(&p->p_next, &tmp->s_procQ);
+
+    p->p_semkey = keys[0];
     return (FALSE);  
 }
 
 /*
-    Remove the first PCB blocked on the semaphore with the corresponding key
-    after the removal of the process from the queue checks that the queue hasn't become empty
-    and if happened return the semd to the free list (rmvEmptySemd)
+    Remove the first PCB blocked on the semaphore with the corresponding key, the PCB is
+    removed also from the other semaphores it was waiting on (wait-any) and the index of
+    this one is recorded in p_waitindex. The semd with an empty queue are returned to the free list.
 
     key: the key associated to the semaphore
     return: the first PCB of that semaphore, NULL if error happened
@@ -106,45 +277,75 @@ pcb_t* removeBlocked(int *key) {
     if (semd == NULL || list_empty(&semd->s_procQ))
         return (NULL);
         
-    struct list_head *pos = list_next(&semd->s_procQ);
-    pcb_t *proc = container_of(pos, pcb_t , p_next);
-    list_del(pos);
-
-    //Checks that the semd s_procQ hasn't become empty and eventually deallocates it
-    rmvEmptySemd(semd);
+    semwait_t *w = container_of(list_next(&semd->s_procQ), semwait_t, w_next);
+    pcb_t *proc = w->w_proc;
 
-    proc->p_semkey = NULL;    
+    proc->p_waitindex = w - proc->p_wait;
+    unlinkWaits(proc);
 
     return(proc);   
 }
 
 /*
-    This function removes the PCB pointed by p from the semaphore's queue (found with the semkey)
-    where it's blocked, then if the queue after the removal becomes empty the function deletes
-    also the semaphore descriptor from the list and insert it back in the free list.
+    Removes all the PCBs blocked on the semaphore with the corresponding key with a single
+    lookup, they are appended to the given list (linked by p_next) in the order of the
+    semaphore queue, so that the priority order is kept for the priority wake policy.
+
+    key: the key associated to the semaphore
+    procs: the list where the removed PCBs are appended
+    return: the number of PCBs removed
+*/
+u_int removeAllBlocked(int *key, struct list_head *procs) {
+    semd_t *semd = getSemd(key);
+    u_int removed = 0;
+
+    // When the last one is removed the semd is freed, but its queue is (and stays) empty
+    while (semd != NULL && ! list_empty(&semd->s_procQ)) {
+        semwait_t *w = container_of(list_next(&semd->s_procQ), semwait_t, w_next);
+        pcb_t *proc = w->w_proc;
+
+        proc->p_waitindex = w - proc->p_wait;
+        unlinkWaits(proc);
+        list_add_tail(&proc->p_next, procs);
+        removed++;
+    }
+
+    return (removed);
+}
+
+/*
+    This function removes the PCB pointed by p from the semaphores queues where it's blocked
+    (each in constant time through its wait nodes), then the semaphore descriptors with an
+    empty queue are deleted from the list and inserted back in the free list.
 
     p: the PCB wich has to be removed from the queue
     return: the PCB removed if found, NULL if not found 
 */
 pcb_t* outBlocked(pcb_t *p) {
-    semd_t *semd = getSemd(p->p_semkey);
-    struct list_head *pos;
-
-    if (p == NULL || semd == NULL)
+    if (p == NULL || p->p_nwait == 0)
         return NULL;
 
-    // Cicles till the PCB is found
-    list_for_each(pos, &semd->s_procQ) {  
-        pcb_t *tmp = container_of(pos, pcb_t, p_next);
-        
-        if (p == tmp) { 
-            list_del(&tmp->p_next);
-            rmvEmptySemd(semd); //If the semd->s_procQ became an empty list, removes semd from the semdActive_list
-            return (tmp);
+    unlinkWaits(p);
+    return (p);
+}
+
+/*
+    This function moves a blocked PCB whose priority has changed in the semaphores queues
+    sorted by priority where it's waiting (each in constant time through its wait nodes),
+    the ones in FIFO order are left as they are. The time of the wait isn't reset.
+
+    p: the blocked PCB
+    return: void
+*/
+void requeueBlocked(pcb_t *p) {
+    for (u_int i = 0; p != NULL && i < p->p_nwait; i++) {
+        semwait_t *w = &p->p_wait[i];
+
+        if (w->w_bucket < SEM_PRIO_BUCKETS) {
+            semdDetach(w);
+            semdInsertSorted(w->w_semd, w);
         }
     }
-
-    return (NULL);
 }
 
 /*
@@ -165,7 +366,19 @@ pcb_t* headBlocked(int *key) {
 
     //Takes the first element in the queue and returns it
     pos = list_next(&semd->s_procQ);
-    return (container_of(pos, pcb_t, p_next));
+    return (container_of(pos, semwait_t, w_next)->w_proc);
+}
+
+/*
+    This function returns the number of PCBs blocked on a semaphore.
+
+    key: the semaphore's key
+    return: the length of the semaphore queue, 0 if no PCB is blocked on it
+*/
+u_int countBlocked(int *key) {
+    semd_t* semd = getSemd(key);
+
+    return ((semd != NULL) ? semd->s_len : 0);
 }
 
 /*
@@ -190,3 +403,228 @@ void outChildBlocked(pcb_t *p) {
         }
     }
 }
+
+
+/*
+    Auxiliary function that returns TRUE if the attributes entry can be freed: no attribute
+    is set and no process is blocked on the semaphore (only the stats would be lost)
+
+    attr: the attributes entry
+    return: TRUE if the entry can be freed, else FALSE
+*/
+HIDDEN u_int semAttrUnused(semattr_t *attr) {
+    return (attr->flags == 0 && attr->owner == NULL && getSemd(attr->key) == NULL);
+}
+
+/*
+    This function returns the attributes of the semaphore with the given key, they are kept
+    in a table apart from the semd since they must last also when no process is blocked.
+    If the semaphore has no attributes a new (wiped) entry can be allocated, when the table
+    is full the entry with only the stats of the least contended semaphore is reused
+    (an entry with some attribute set is never reused). The active semd is linked to it.
+
+    key: the key of the semaphore
+    alloc: TRUE if a new entry has to be allocated when not found
+    return: the attributes of the semaphore, NULL if not found (or the table is full)
+*/
+semattr_t* getSemAttr(int *key, u_int alloc) {
+    semattr_t *free_attr = NULL;
+
+    for (u_int i = 0; i < MAXSEMATTR && key != NULL; i++) {
+        if (semAttr_table[i].key == key)
+            return (&semAttr_table[i]);
+
+        if (semAttr_table[i].key == NULL && free_attr == NULL)
+            free_attr = &semAttr_table[i];
+    }
+
+    if (! alloc || key == NULL)
+        return (NULL);
+
+    // Table full, the stats of the least contended semaphore are dropped
+    semattr_t *victim = NULL;
+
+    for (u_int i = 0; i < MAXSEMATTR && free_attr == NULL; i++) {
+        semattr_t *attr = &semAttr_table[i];
+
+        if ((victim == NULL || attr->stats.blocked < victim->stats.blocked) && semAttrUnused(attr))
+            victim = attr;
+    }
+
+    free_attr = (free_attr != NULL) ? free_attr : victim;
+
+    if (free_attr == NULL)
+        return (NULL);
+
+    wipe_Memory(free_attr, sizeof(semattr_t));
+    free_attr->key = key;
+
+    semd_t *semd = getSemd(key);
+    (semd != NULL) ? (semd->s_attr = free_attr) : NULL;
+    return (free_attr);
+}
+
+
+// Frees the attributes entry if no attribute is set anymore and there are no stats to keep
+void putSemAttr(semattr_t *attr) {
+    if (attr != NULL && semAttrUnused(attr) && attr->stats.blocked == 0)
+        attr->key = NULL;
+}
+
+
+/*
+    This function returns the key of one of the semaphores owned by the given process
+    (semaphores in mutex mode that the process has acquired and not yet released)
+
+    owner: the owner process
+    return: the key of the semaphore, NULL if the process doesn't own any semaphore
+*/
+int* getOwnedSem(pcb_t *owner) {
+    for (u_int i = 0; i < MAXSEMATTR; i++)
+        if (semAttr_table[i].key != NULL && semAttr_table[i].owner == owner)
+            return (semAttr_table[i].key);
+
+    return (NULL);
+}
+
+
+/*
+    This function computes the priority that a process inherits from the processes blocked
+    on the semaphores it owns, that is the highest among them and its original priority
+
+    owner: the owner process
+    return: the inherited priority
+*/
+int inheritedPriority(pcb_t *owner) {
+    int priority = owner->original_priority;
+
+    for (u_int i = 0; i < MAXSEMATTR; i++) {
+        semd_t *semd = (semAttr_table[i].owner == owner) ? getSemd(semAttr_table[i].key) : NULL;
+        struct list_head *pos;
+
+        if (semd == NULL)
+            continue;
+
+        list_for_each(pos, &semd->s_procQ) {
+            pcb_t *waiter = container_of(pos, semwait_t, w_next)->w_proc;
+            priority = (waiter->priority > priority) ? waiter->priority : priority;
+        }
+    }
+
+    return (priority);
+}
+
+
+/*
+    This function sets or clears a mode flag in the attributes of a semaphore,
+    the attributes entry is allocated if needed
+
+    key: the key of the semaphore
+    flag: the flag (SEMATTR_*)
+    on: TRUE to set the flag, FALSE to clear it
+    return: 0 on success, -1 if there are no free attributes
+*/
+int setSemFlag(int *key, u_int flag, u_int on) {
+    semattr_t *attr = getSemAttr(key, on);
+
+    if (attr == NULL)
+        return (on ? FAILURE : SUCCESS);
+
+    attr->flags = on ? (attr->flags | flag) : (attr->flags & ~flag);
+    putSemAttr(attr);
+    return (SUCCESS);
+}
+
+
+/*
+    This function sets the wake policy of a semaphore, the order in wich the blocked
+    processes are waken up: FIFO (the default) or highest priority first.
+    NOTE: the processes already blocked keep their position in the queue.
+
+    key: the key of the semaphore
+    policy: SEM_WAKE_FIFO or SEM_WAKE_PRIORITY
+    return: 0 on success, -1 on failure (unknown policy or no free attributes)
+*/
+int setWakePolicy(int *key, u_int policy) {
+    if (policy != SEM_WAKE_FIFO && policy != SEM_WAKE_PRIORITY)
+        return (FAILURE);
+
+    return (setSemFlag(key, SEMATTR_PRIORITY, policy == SEM_WAKE_PRIORITY));
+}
+
+
+/*
+    Auxiliary function that returns the stats of the i-th candidate for topSemStats: first
+    the entries of the attributes table (plus the stats of their semd, if active) and then
+    the active semd without an entry, whose stats aren't in the table yet
+
+    i: the index of the candidate
+    stats: where the stats of the candidate are copied (key included)
+    return: TRUE if the candidate exists and has some stats, else FALSE
+*/
+HIDDEN u_int semStatsCandidate(u_int i, semstats_t *stats) {
+    wipe_Memory(stats, sizeof(semstats_t));
+
+    if (i < MAXSEMATTR) {
+        semattr_t *attr = &semAttr_table[i];
+        semd_t *semd = (attr->key != NULL) ? getSemd(attr->key) : NULL;
+
+        if (attr->key == NULL)
+            return (FALSE);
+
+        addSemStats(stats, &attr->stats);
+        (semd != NULL) ? addSemStats(stats, &semd->s_stats) : 0;
+        stats->key = attr->key;
+    }
+
+    else {
+        semd_t *semd = &semdTmp_arr[i - MAXSEMATTR];
+
+        if (list_empty(&semd->s_procQ) || semd->s_attr != NULL)
+            return (FALSE);
+
+        addSemStats(stats, &semd->s_stats);
+        stats->key = semd->s_key;
+    }
+
+    return (stats->blocked > 0);
+}
+
+/*
+    This function copies the stats of the most contended semaphores (the ones with the
+    highest total wait time) in the given array, sorted from the most contended
+
+    stats: the array where the stats are copied
+    n: the max number of semaphores
+    return: the number of semaphores copied
+*/
+u_int topSemStats(semstats_t *stats, u_int n) {
+    u_int copied = 0;
+    int last = -1;
+    semstats_t candidate;
+
+    // Selection of the next most contended after the last one copied
+    for (; copied < n; copied++) {
+        int next = -1;
+
+        for (u_int i = 0; i < MAXSEMATTR + MAXSEMD; i++) {
+            if (! semStatsCandidate(i, &candidate))
+                continue;
+
+            u_int after_last = (last < 0 || candidate.total_wait < stats[copied - 1].total_wait ||
+                                (candidate.total_wait == stats[copied - 1].total_wait && (int) i > last));
+
+            if (after_last && (next < 0 || candidate.total_wait > stats[copied].total_wait)) {
+                copy_Memory(&stats[copied], &candidate, sizeof(semstats_t));
+                next = i;
+            }
+        }
+
+        if (next < 0)
+            break;
+
+        last = next;
+    }
+
+    return (copied);
+}
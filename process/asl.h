@@ -9,9 +9,22 @@ unsigned int emptyASL();
 void initASL(void);
 
 int insertBlocked(int *key,pcb_t* p);
+int insertBlockedAny(int *keys[], u_int n, pcb_t *p);
 pcb_t* removeBlocked(int *key);
+u_int removeAllBlocked(int *key, struct list_head *procs);
 pcb_t* outBlocked(pcb_t *p);
+void requeueBlocked(pcb_t *p);
 pcb_t* headBlocked(int *key);
+u_int countBlocked(int *key);
 void outChildBlocked(pcb_t *p);
 
+/* Semaphore attributes functions */
+semattr_t* getSemAttr(int *key, u_int alloc);
+void putSemAttr(semattr_t *attr);
+int* getOwnedSem(pcb_t *owner);
+int inheritedPriority(pcb_t *owner);
+int setSemFlag(int *key, u_int flag, u_int on);
+int setWakePolicy(int *key, u_int policy);
+u_int topSemStats(semstats_t *stats, u_int n);
+
 #endif
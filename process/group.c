@@ -0,0 +1,161 @@
+#include "../include/system_const.h"
+#include "../include/types_bikaya.h"
+#include "../include/listx.h"
+#include "group.h"
+
+
+/*
+    A process group has a CPU bandwidth quota: its members together can use at most quota
+    clocks of CPU each period. When the quota is over the members are throttled, out of the
+    ready queue, till the next period starts (checked on every interrupt, as the timers).
+    A group is created for a subtree of processes (SETQUOTA) and the new children join the
+    group of the parent. A group is freed when its last member leaves it.
+*/
+HIDDEN group_t groupTable[MAXGROUPS];
+
+// TRUE if the clock a comes before the clock b (the TOD_LO wrap around is considered)
+#define CLOCK_BEFORE(a, b) ((int)((a) - (b)) < 0)
+
+
+
+// Marks all the groups as free
+void initGroups(void) {
+    for (u_int i = 0; i < MAXGROUPS; i++)
+        groupTable[i].quota = 0;
+}
+
+
+/*
+    Allocates a new group without members, its first period starts now
+
+    quota: the CPU time the members can use each period (in clocks)
+    period: the length of the period (in clocks)
+    return: the group, NULL if there are no free groups
+*/
+group_t* allocGroup(u_int quota, u_int period) {
+    for (u_int i = 0; i < MAXGROUPS; i++) {
+        group_t *group = &groupTable[i];
+
+        if (group->quota == 0) {
+            group->quota = quota;
+            group->period = period;
+            group->used = 0;
+            group->period_start = TOD_LO;
+            group->members = 0;
+            INIT_LIST_HEAD(&group->throttled);
+            return (group);
+        }
+    }
+
+    return (NULL);
+}
+
+
+/*
+    Moves a process in a group, leaving the one it was member of (that is freed if it
+    has no more members). The process must not be throttled.
+
+    p: the process
+    group: the new group, NULL to only leave the old one
+    return: void
+*/
+void group_join(pcb_t *p, group_t *group) {
+    group_t *old = p->p_group;
+
+    if (old != NULL && --old->members == 0)
+        old->quota = 0;
+
+    p->p_group = group;
+    group != NULL ? group->members++ : 0;
+}
+
+
+// Charges the CPU time used by a process to its group (called by update_time)
+void group_charge(pcb_t *p, u_int clocks) {
+    if (p->p_group != NULL)
+        p->p_group->used += clocks;
+}
+
+
+// Returns TRUE if the process is in a group that has used its whole quota
+u_int group_exhausted(pcb_t *p) {
+    return (p->p_group != NULL && p->p_group->used >= p->p_group->quota);
+}
+
+
+/*
+    Returns the time slice of a process at dispatch, that can't go past the quota left to
+    its group (the group must not be exhausted)
+
+    p: the process to be dispatched
+    quantum: the time slice given by the scheduler
+    return: the time slice (in clocks)
+*/
+u_int group_quantum(pcb_t *p, u_int quantum) {
+    group_t *group = p->p_group;
+
+    if (group != NULL && group->quota - group->used < quantum)
+        return (group->quota - group->used);
+
+    return (quantum);
+}
+
+
+/*
+    Throttles a process of an exhausted group, it waits in the group till the next period
+
+    p: the process (not in the ready queue)
+    return: void
+*/
+void group_throttle(pcb_t *p) {
+    list_add_tail(&p->p_next, &p->p_group->throttled);
+    p->p_throttled = TRUE;
+}
+
+
+// Removes a throttled process from its group queue
+void group_unthrottle(pcb_t *p) {
+    list_del_init(&p->p_next);
+    p->p_throttled = FALSE;
+}
+
+
+// Returns TRUE if some process is throttled (it will be ready at the next period)
+u_int group_any_throttled(void) {
+    for (u_int i = 0; i < MAXGROUPS; i++)
+        if (groupTable[i].quota && ! list_empty(&groupTable[i].throttled))
+            return (TRUE);
+
+    return (FALSE);
+}
+
+
+/*
+    Starts a new period for the groups whose period has ended, the time used over the quota
+    in a period is taken from the next one. The throttled processes of the groups that have
+    quota again are moved in the released list, to be added to the ready queue.
+
+    now: the current clock
+    released: the list where the released processes are added (linked by p_next)
+    return: void
+*/
+void group_refill(u_int now, struct list_head *released) {
+    for (u_int i = 0; i < MAXGROUPS; i++) {
+        group_t *group = &groupTable[i];
+
+        if (group->quota == 0 || CLOCK_BEFORE(now, group->period_start + group->period))
+            continue;
+
+        group->used = (group->used > group->quota) ? group->used - group->quota : 0;
+        group->period_start += group->period;
+        // After a long time without running the periods aren't recovered
+        if (! CLOCK_BEFORE(now, group->period_start + group->period))
+            group->period_start = now;
+
+        while (group->used < group->quota && ! list_empty(&group->throttled)) {
+            pcb_t *p = container_of(list_next(&group->throttled), pcb_t, p_next);
+            group_unthrottle(p);
+            list_add_tail(&p->p_next, released);
+        }
+    }
+}
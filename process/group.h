@@ -0,0 +1,17 @@
+#ifndef __GROUP_H
+#define __GROUP_H
+
+#include "../include/types_bikaya.h"
+
+void initGroups(void);
+group_t* allocGroup(u_int quota, u_int period);
+void group_join(pcb_t *p, group_t *group);
+void group_charge(pcb_t *p, u_int clocks);
+u_int group_exhausted(pcb_t *p);
+u_int group_quantum(pcb_t *p, u_int quantum);
+void group_throttle(pcb_t *p);
+void group_unthrottle(pcb_t *p);
+u_int group_any_throttled(void);
+void group_refill(u_int now, struct list_head *released);
+
+#endif
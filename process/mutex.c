@@ -0,0 +1,170 @@
+#include "../include/system_const.h"
+#include "../include/types_bikaya.h"
+#include "scheduler.h"
+#include "asl.h"
+#include "pcb.h"
+#include "mutex.h"
+
+
+/*
+    Semaphores in mutex mode record the process that holds them (the owner), while a
+    process with higher priority waits on the mutex the owner inherits its priority,
+    so that it can't be starved by the processes with a priority in between.
+*/
+
+
+
+/*
+    Recomputes the priority inherited by a process from the waiters of its mutexes, after
+    one of them has been acquired or released, and applies it
+
+    p: the process
+    return: void
+*/
+HIDDEN void update_inherited(pcb_t *p) {
+    p->inherited_priority = inheritedPriority(p);
+    scheduler_set_priority(p, mutex_priority(p));
+}
+
+
+/*
+    Turns on or off the mutex mode of a semaphore, the semaphore is supposed to be
+    binary and not held by anyone when the mode is turned on
+
+    key: the key of the semaphore
+    on: TRUE to turn the mutex mode on, FALSE to turn it off
+    return: 0 on success, -1 if there are no free attributes
+*/
+int mutex_mode(int *key, u_int on) {
+    semattr_t *attr = getSemAttr(key, on);
+
+    if (attr == NULL)
+        return (on ? FAILURE : SUCCESS);
+
+    if (on)
+        attr->flags |= SEMATTR_MUTEX;
+    else {
+        mutex_release(key, attr->owner);
+        attr->flags &= ~SEMATTR_MUTEX;
+        putSemAttr(attr);
+    }
+
+    return (SUCCESS);
+}
+
+
+/*
+    Returns the priority a process must be scheduled with, that is its original
+    priority raised to the one inherited (only while it owns some mutex)
+
+    p: the process
+    return: the priority
+*/
+int mutex_priority(pcb_t *p) {
+    if (p->owned_mutexes && p->inherited_priority > p->original_priority)
+        return (p->inherited_priority);
+
+    return (p->original_priority);
+}
+
+
+/*
+    Called before a process is blocked on a semaphore, if the semaphore is a mutex its
+    owner inherits the waiter priority. The inheritance is transitive: if the owner is
+    itself waiting on another mutex, the owner of that one is raised as well.
+
+    key: the key of the semaphore
+    waiter: the process that is going to be blocked
+    return: void
+*/
+void mutex_wait(int *key, pcb_t *waiter) {
+    semattr_t *attr = getSemAttr(key, FALSE);
+    int priority = waiter->priority;
+
+    // The chain of owners can't be longer than the number of processes
+    for (u_int i = 0; i < MAXPROC && attr != NULL && (attr->flags & SEMATTR_MUTEX); i++) {
+        pcb_t *owner = attr->owner;
+
+        if (owner == NULL || owner == waiter || mutex_priority(owner) >= priority)
+            return ;
+
+        owner->inherited_priority = priority;
+        scheduler_set_priority(owner, (owner->priority > priority) ? owner->priority : priority);
+
+        attr = (owner->p_semkey != NULL) ? getSemAttr(owner->p_semkey, FALSE) : NULL;
+    }
+}
+
+
+/*
+    Called after a process has taken a unit of a semaphore (also when it's handed off by
+    a V), if the semaphore is a mutex the process becomes its owner
+
+    key: the key of the semaphore
+    p: the process that acquired the semaphore
+    return: void
+*/
+void mutex_acquire(int *key, pcb_t *p) {
+    semattr_t *attr = getSemAttr(key, FALSE);
+
+    if (attr == NULL || !(attr->flags & SEMATTR_MUTEX) || p == NULL)
+        return ;
+
+    attr->owner = p;
+    p->owned_mutexes++;
+    // Other processes could be still waiting on the mutex
+    update_inherited(p);
+}
+
+
+/*
+    Returns FALSE if the semaphore is a mutex held by a process other than the caller,
+    only the owner can release it (a free mutex can be released by anyone)
+
+    key: the key of the semaphore
+    caller: the process that wants to release the semaphore
+    return: TRUE if the caller can release the semaphore, else FALSE
+*/
+u_int mutex_can_release(int *key, pcb_t *caller) {
+    semattr_t *attr = getSemAttr(key, FALSE);
+
+    return (attr == NULL || attr->owner == NULL || attr->owner == caller);
+}
+
+
+/*
+    Called when a semaphore is released, if the semaphore is a mutex the owner loses it
+    and the priority inherited from its waiters. A release by another process is refused.
+
+    key: the key of the semaphore
+    caller: the process that releases the semaphore
+    return: FALSE if the semaphore is a mutex held by another process, else TRUE
+*/
+u_int mutex_release(int *key, pcb_t *caller) {
+    semattr_t *attr = getSemAttr(key, FALSE);
+    pcb_t *owner = (attr != NULL) ? attr->owner : NULL;
+
+    if (owner == NULL)
+        return (TRUE);
+
+    if (owner != caller)
+        return (FALSE);
+
+    attr->owner = NULL;
+    owner->owned_mutexes--;
+    update_inherited(owner);
+    return (TRUE);
+}
+
+
+/*
+    Called when a process leaves the queue of a mutex (waken up, timed out, killed or because
+    another semaphore of a wait-any was released), the owner loses the priority inherited from it
+
+    owner: the owner of the mutex
+    return: void
+*/
+void mutex_waiter_left(pcb_t *owner) {
+    if (owner != NULL && owner->inherited_priority > owner->original_priority)
+        update_inherited(owner);
+}
@@ -0,0 +1,14 @@
+#ifndef __MUTEX_H
+#define __MUTEX_H
+
+#include "../include/types_bikaya.h"
+
+int mutex_mode(int *key, u_int on);
+int mutex_priority(pcb_t *p);
+void mutex_wait(int *key, pcb_t *waiter);
+void mutex_acquire(int *key, pcb_t *p);
+u_int mutex_can_release(int *key, pcb_t *caller);
+u_int mutex_release(int *key, pcb_t *caller);
+void mutex_waiter_left(pcb_t *owner);
+
+#endif
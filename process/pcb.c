@@ -61,6 +61,7 @@ pcb_t *allocPcb(void) {
     INIT_LIST_HEAD(&newPcb->p_next);
     INIT_LIST_HEAD(&newPcb->p_child);
     INIT_LIST_HEAD(&newPcb->p_sib);
+    INIT_LIST_HEAD(&newPcb->p_timer);
 
     return(newPcb);
 }
@@ -123,6 +124,30 @@ void insertProcQ(struct list_head *head, pcb_t *p) {
     }
 }
 
+/*
+    Moves all the PCBs of the src queue in the head queue with a single pass, both the
+    queues must be sorted by priority. As in insertProcQ, a moved PCB goes after the ones
+    with the same priority already in the queue. At the end src is an empty queue.
+
+    head: the pointer to the dummy of the destination queue
+    src: the pointer to the dummy of the queue to be moved
+    return: void
+*/
+void mergeProcQ(struct list_head *head, struct list_head *src) {
+    struct list_head *pos = list_next(head);
+
+    while (! list_empty(src)) {
+        pcb_t *p = container_of(list_next(src), pcb_t, p_next);
+
+        // Skips the PCBs with a priority higher or equal, the next ones from src can't go before them
+        while (pos != head && container_of(pos, pcb_t, p_next)->priority >= p->priority)
+            pos = pos->next;
+
+        list_del(&p->p_next);
+        list_add_tail(&p->p_next, pos);
+    }
+}
+
 /*
     This function returns a reference the first element of the pcb_active_queue,
      so the first PCB in the priority queue (after checking for errors). 
@@ -180,6 +205,132 @@ pcb_t *outProcQ(struct list_head *head, pcb_t *p) {
     return (NULL);
 }
 
+/* PCB HEAP HANDLING FUNCTIONS */
+
+// TRUE if key a comes before key b, the keys are clocks or virtual times that can wrap around
+#define HEAP_BEFORE(a, b) ((int)((a) - (b)) < 0)
+
+/*
+    Places the given PCB in the heap slot i, keeping track of the index in the PCB
+    (used to remove it from the middle of the heap)
+
+    heap: the heap
+    i: the slot
+    p: the PCB
+    return: void
+*/
+HIDDEN void heap_set(pcb_heap_t *heap, u_int i, pcb_t *p) {
+    heap->elem[i] = p;
+    p->p_heapindex = i;
+}
+
+/*
+    Moves up the PCB in the slot i till its parent has a lower key
+
+    heap: the heap
+    i: the slot of the PCB
+    return: the final slot of the PCB
+*/
+HIDDEN u_int heap_up(pcb_heap_t *heap, u_int i) {
+    pcb_t *p = heap->elem[i];
+
+    while (i > 0 && HEAP_BEFORE(p->p_heapkey, heap->elem[(i - 1) / 2]->p_heapkey)) {
+        heap_set(heap, i, heap->elem[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+
+    heap_set(heap, i, p);
+    return (i);
+}
+
+/*
+    Moves down the PCB in the slot i till its children have a higher key
+
+    heap: the heap
+    i: the slot of the PCB
+    return: void
+*/
+HIDDEN void heap_down(pcb_heap_t *heap, u_int i) {
+    pcb_t *p = heap->elem[i];
+
+    for (u_int child = 2 * i + 1; child < heap->size; child = 2 * i + 1) {
+        // The child with the lowest key
+        if (child + 1 < heap->size && HEAP_BEFORE(heap->elem[child + 1]->p_heapkey, heap->elem[child]->p_heapkey))
+            child++;
+
+        if (! HEAP_BEFORE(heap->elem[child]->p_heapkey, p->p_heapkey))
+            break;
+
+        heap_set(heap, i, heap->elem[child]);
+        i = child;
+    }
+
+    heap_set(heap, i, p);
+}
+
+/*
+    Initializes an empty heap of PCBs, sorted by p_heapkey (the lowest first)
+
+    heap: the heap
+    return: void
+*/
+void mkEmptyPcbHeap(pcb_heap_t *heap) {
+    heap->size = 0;
+}
+
+// Returns TRUE if the heap is empty
+int emptyPcbHeap(pcb_heap_t *heap) {
+    return (heap->size == 0);
+}
+
+/*
+    Inserts a PCB in the heap in O(log n), the key must be already set in p_heapkey.
+    The heap has room for all the PCBs, a PCB can be in only one heap at a time.
+
+    heap: the heap
+    p: the PCB to be inserted
+    return: void
+*/
+void insertPcbHeap(pcb_heap_t *heap, pcb_t *p) {
+    heap_set(heap, heap->size++, p);
+    heap_up(heap, p->p_heapindex);
+}
+
+// Returns the PCB with the lowest key without removing it, NULL if the heap is empty
+pcb_t *headPcbHeap(pcb_heap_t *heap) {
+    return (heap->size ? heap->elem[0] : NULL);
+}
+
+/*
+    Removes the given PCB from the heap in O(log n), wherever it is
+
+    heap: the heap
+    p: the PCB to be removed
+    return: the PCB, NULL if it isn't in the heap
+*/
+pcb_t *outPcbHeap(pcb_heap_t *heap, pcb_t *p) {
+    u_int i = p->p_heapindex;
+
+    if (i >= heap->size || heap->elem[i] != p)
+        return (NULL);
+
+    // The last PCB takes its place, then it's moved up or down to where it belongs
+    heap->size--;
+    if (i < heap->size) {
+        heap_set(heap, i, heap->elem[heap->size]);
+        if (heap_up(heap, i) == i)
+            heap_down(heap, i);
+    }
+
+    heap->elem[heap->size] = NULL;
+    return (p);
+}
+
+// Removes and returns the PCB with the lowest key, NULL if the heap is empty
+pcb_t *removePcbHeap(pcb_heap_t *heap) {
+    return (heap->size ? outPcbHeap(heap, heap->elem[0]) : NULL);
+}
+
 /*
     This function check that the given PCB has no childs. If the argument
     is NULL then returnes FALSE.
@@ -13,10 +13,19 @@ pcb_t *allocPcb(void);
 void mkEmptyProcQ(struct list_head *head);
 int emptyProcQ(struct list_head *head);
 void insertProcQ(struct list_head *head, pcb_t *p);
+void mergeProcQ(struct list_head *head, struct list_head *src);
 pcb_t *headProcQ(struct list_head *head);
 pcb_t *removeProcQ(struct list_head *head);
 pcb_t *outProcQ(struct list_head *head, pcb_t *p);
 
+/* PCB heap handling functions */
+void mkEmptyPcbHeap(pcb_heap_t *heap);
+int emptyPcbHeap(pcb_heap_t *heap);
+void insertPcbHeap(pcb_heap_t *heap, pcb_t *p);
+pcb_t *headPcbHeap(pcb_heap_t *heap);
+pcb_t *outPcbHeap(pcb_heap_t *heap, pcb_t *p);
+pcb_t *removePcbHeap(pcb_heap_t *heap);
+
 /* Tree view functions */
 int emptyChild(pcb_t *this);
 void insertChild(pcb_t *prnt, pcb_t *p);
@@ -0,0 +1,41 @@
+#ifndef __SCHED_CLASS_H
+#define __SCHED_CLASS_H
+
+/*
+    Scheduling class interface. The policy is chosen at build time with the SCHED_POLICY
+    CMake option and the header of the class is included here: its hooks are static inline
+    functions called directly by scheduler.c, so the indirection costs nothing at runtime.
+    NOTE: the classes keep their state in the header, it must be included only by scheduler.c!
+
+    Each class defines:
+    sched_init(void)                    initializes the ready processes structure
+    sched_enqueue(pcb_t *p)             inserts a ready process
+    sched_enqueue_all(list_head *procs) inserts a list of ready processes (linked by p_next)
+    sched_dequeue(pcb_t *p)             removes a ready process wherever it is (the scheduler tracks who is ready, p_ready)
+    sched_pick_next(void)               removes and returns the next process to be executed
+    sched_empty(void)                   TRUE if no process is ready
+    sched_tick(pcb_t *p)                charges the CPU time to a process preempted (still ready)
+    sched_wakeup(pcb_t *p, u_int first) charges the CPU time to a process waken up (or new)
+    sched_yield(pcb_t *p)               moves a process that yields (after sched_tick) behind its peers
+    sched_priority(pcb_t *p)            priority of a process when it's dispatched
+    sched_quantum(pcb_t *p)             time slice (in clocks) of a process when it's dispatched
+    sched_preempts(pcb_t *p, pcb_t *cur) TRUE if the ready process p goes enough before the running one to preempt it
+
+    The CPU time to charge is the one spent since the last sched_tick or sched_wakeup, the
+    p_cpu_time field of the PCB is left to the class to keep track of it.
+*/
+
+#if defined(SCHED_MLFQ)
+#include "sched_mlfq.h"
+#elif defined(SCHED_FAIR)
+#include "sched_fair.h"
+#elif defined(SCHED_STRIDE)
+#include "sched_stride.h"
+#else
+#include "sched_prio.h"
+#endif
+
+// The real-time processes are scheduled by earliest deadline first, ahead of the selected class
+#include "sched_edf.h"
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef __SCHED_EDF_H
+#define __SCHED_EDF_H
+
+#include "../include/types_bikaya.h"
+#include "pcb.h"
+
+/*
+    Earliest deadline first class, layered ahead of the selected one: a real-time process
+    (registered with EDFREGISTER) is released at the start of each period with a budget of
+    CPU time and an absolute deadline, and the ready ones are executed before any other
+    process, the earliest deadline first. A job ends with EDFWAIT, that waits for the next
+    release. A job that uses its whole budget is throttled till the next release.
+    NOTE: as the classes it keeps its state in the header, it must be included only by scheduler.c!
+*/
+
+// Utilisation (budget / relative deadline) is in fixed point, EDF_UTIL_SCALE is the whole CPU
+#define EDF_UTIL_SCALE 1024
+// Max total utilisation admitted (90%), the rest is left to the other processes and the kernel
+#define EDF_UTIL_MAX   ((EDF_UTIL_SCALE * 9) / 10)
+
+#define EDF_UTIL(budget, deadline) (((budget) / (deadline)) * EDF_UTIL_SCALE + ((budget) % (deadline)) * EDF_UTIL_SCALE / (deadline))
+// TRUE if the clock a is before the clock b (with wraparound)
+#define EDF_BEFORE(a, b) ((int)((a) - (b)) < 0)
+
+// Released jobs sorted by absolute deadline, and processes waiting for their release sorted by release time
+HIDDEN pcb_heap_t edf_ready;
+HIDDEN pcb_heap_t edf_sleeping;
+// Utilisation of the admitted real-time processes
+HIDDEN u_int edf_util = 0;
+
+
+HIDDEN inline void edf_init(void) {
+    mkEmptyPcbHeap(&edf_ready);
+    mkEmptyPcbHeap(&edf_sleeping);
+    edf_util = 0;
+}
+
+// TRUE if the process is scheduled by the EDF class
+HIDDEN inline int edf_task(pcb_t *p) {
+    return (p->p_edf.period != 0);
+}
+
+HIDDEN inline int edf_empty(void) {
+    return (emptyPcbHeap(&edf_ready));
+}
+
+// TRUE if some real-time process waits for its release (the system can't be shut down)
+HIDDEN inline int edf_waiting(void) {
+    return (! emptyPcbHeap(&edf_sleeping));
+}
+
+HIDDEN inline pcb_t* edf_pick_next(void) {
+    return (removePcbHeap(&edf_ready));
+}
+
+// Removes a released real-time process from the ready queue, NULL if it isn't there (a throttled
+// or sleeping one stays where it is, it can't run before its next release)
+HIDDEN inline pcb_t* edf_dequeue(pcb_t *p) {
+    return (outPcbHeap(&edf_ready, p));
+}
+
+
+/*
+    Starts a new job of a real-time process, with the whole budget and the deadline
+    relative to the start of the period
+
+    p: the real-time process
+    return: void
+*/
+HIDDEN inline void edf_new_job(pcb_t *p) {
+    edf_t *edf = &p->p_edf;
+
+    edf->used = 0;
+    edf->throttled = FALSE;
+    edf->abs_deadline = edf->release + edf->deadline;
+    edf->release += edf->period;
+}
+
+
+// Puts a real-time process to sleep till its next release
+HIDDEN inline void edf_sleep(pcb_t *p) {
+    p->p_heapkey = p->p_edf.release;
+    insertPcbHeap(&edf_sleeping, p);
+}
+
+
+/*
+    Charges the CPU time used since the last time the process was added to the ready
+    queue to the budget of its job, then inserts it in the ready queue by deadline or,
+    if the budget is over, throttles it till the next release
+
+    p: the real-time process
+    return: void
+*/
+HIDDEN inline void edf_enqueue(pcb_t *p) {
+    u_int cpu_time = p->p_time.usermode_time + p->p_time.kernelmode_time;
+    edf_t *edf = &p->p_edf;
+
+    edf->used += cpu_time - p->p_cpu_time;
+    p->p_cpu_time = cpu_time;
+
+    if (edf->used >= edf->budget) {
+        edf->throttled = TRUE;
+        edf_sleep(p);
+    }
+    else {
+        p->p_heapkey = edf->abs_deadline;
+        insertPcbHeap(&edf_ready, p);
+    }
+}
+
+
+/*
+    Releases the real-time processes whose period has started, they are appended to the
+    given list (linked by p_next) to be inserted in the ready queue. A throttled job that
+    is still unfinished has missed its deadline (that can't be later than the release).
+
+    now: the current clock
+    released: the list where the released processes are appended
+    return: void
+*/
+HIDDEN inline void edf_release(u_int now, struct list_head *released) {
+    pcb_t *p;
+
+    while ((p = headPcbHeap(&edf_sleeping)) != NULL && ! EDF_BEFORE(now, p->p_edf.release)) {
+        removePcbHeap(&edf_sleeping);
+
+        p->p_edf.misses += p->p_edf.throttled;
+        edf_new_job(p);
+        list_add_tail(&p->p_next, released);
+    }
+}
+
+
+/*
+    Returns the time slice of a process at dispatch: a real-time process can't run past its
+    budget, and no process can run past the next release (so it happens on time)
+
+    p: the process to be dispatched, NULL for the idle
+    quantum: the time slice given by the scheduling class
+    now: the current clock
+    return: the time slice (in clocks)
+*/
+HIDDEN inline u_int edf_quantum(pcb_t *p, u_int quantum, u_int now) {
+    pcb_t *next = headPcbHeap(&edf_sleeping);
+
+    if (p != NULL && edf_task(p))
+        quantum = p->p_edf.budget - p->p_edf.used;
+
+    if (next != NULL && EDF_BEFORE(next->p_edf.release, now + quantum))
+        quantum = EDF_BEFORE(now, next->p_edf.release) ? next->p_edf.release - now : 1;
+
+    return (quantum);
+}
+
+
+/*
+    Sets the real-time parameters of a process, with the admission control: the total
+    utilisation can't go over EDF_UTIL_MAX. The first job is released right away.
+    A period of 0 turns the process back to a normal one.
+
+    p: the process (not in the ready queue)
+    period, budget, deadline: the parameters in clocks, a deadline of 0 is the period
+    now: the current clock
+    return: 0 on success, -1 if the parameters are invalid or the process isn't admitted
+*/
+HIDDEN inline int edf_register(pcb_t *p, u_int period, u_int budget, u_int deadline, u_int now) {
+    edf_t *edf = &p->p_edf;
+    u_int util = edf_task(p) ? EDF_UTIL(edf->budget, edf->deadline) : 0;
+
+    if (period == 0) {
+        edf_util -= util;
+        edf->period = 0;
+        return (SUCCESS);
+    }
+
+    deadline = deadline ? deadline : period;
+    if (budget == 0 || budget > deadline || deadline > period)
+        return (FAILURE);
+
+    if (edf_util - util + EDF_UTIL(budget, deadline) > EDF_UTIL_MAX)
+        return (FAILURE);
+
+    edf_util += EDF_UTIL(budget, deadline) - util;
+    edf->period = period;
+    edf->budget = budget;
+    edf->deadline = deadline;
+    edf->release = now;
+    edf_new_job(p);
+
+    // The CPU time used before doesn't count in the budget
+    p->p_cpu_time = p->p_time.usermode_time + p->p_time.kernelmode_time;
+    return (SUCCESS);
+}
+
+
+// Releases the utilisation of a real-time process that is killed, it doesn't wait for its release anymore
+HIDDEN inline void edf_exit(pcb_t *p) {
+    if (edf_task(p)) {
+        edf_util -= EDF_UTIL(p->p_edf.budget, p->p_edf.deadline);
+        outPcbHeap(&edf_sleeping, p);
+    }
+}
+
+
+/*
+    Ends the current job of a real-time process: if the next period has already started
+    a new job starts right away, else the process has to wait for it
+
+    p: the real-time process (the current one)
+    now: the current clock
+    return: TRUE if the process must wait (it's put to sleep), FALSE if it can go on
+*/
+HIDDEN inline int edf_wait(pcb_t *p, u_int now) {
+    edf_t *edf = &p->p_edf;
+
+    edf->misses += EDF_BEFORE(edf->abs_deadline, now);
+    p->p_cpu_time = p->p_time.usermode_time + p->p_time.kernelmode_time;
+
+    if (! EDF_BEFORE(now, edf->release)) {
+        edf_new_job(p);
+        return (FALSE);
+    }
+
+    edf->throttled = FALSE;
+    edf_sleep(p);
+    return (TRUE);
+}
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef __SCHED_FAIR_H
+#define __SCHED_FAIR_H
+
+#include "../include/types_bikaya.h"
+#include "pcb.h"
+#include "mutex.h"
+
+/*
+    Fair-share class: the ready processes are kept in a heap sorted by virtual runtime,
+    their CPU time scaled by a weight taken from the priority, and the lowest one runs.
+    Under contention the CPU is shared in proportion to the weights.
+*/
+
+// Weight of the priority 0, the virtual runtime of a process with this weight advances as its CPU time
+#define FAIR_WEIGHT_UNIT 1024
+// Number of priorities with a different weight, the higher ones have the weight of the last
+#define FAIR_PRIO_LEVELS 10
+// Virtual runtime a waken up process can be behind the others: sleepers get the CPU soon but can't monopolize it
+#define FAIR_SLEEPER_CREDIT (TIME_SLICE / 2)
+// Virtual runtime a waken up process must be behind the running one to preempt it
+#define FAIR_WAKEUP_GRAN (TIME_SLICE / 4)
+
+// Ready processes sorted by virtual runtime, and the lowest virtual runtime dispatched so far
+HIDDEN pcb_heap_t ready_heap;
+HIDDEN u_int min_vruntime = 0;
+
+// Weight of each priority, each step gives about 25% more CPU than the previous one
+HIDDEN const u_int fair_weight[FAIR_PRIO_LEVELS] = {
+    1024, 1280, 1600, 2000, 2500, 3125, 3906, 4883, 6104, 7629
+};
+
+
+// Returns the CPU time used since the last time the process was charged, scaled by the weight of its priority
+HIDDEN inline u_int fair_burst(pcb_t *p) {
+    int priority = mutex_priority(p);
+    u_int weight = fair_weight[(priority < 0) ? 0 : (priority >= FAIR_PRIO_LEVELS) ? FAIR_PRIO_LEVELS - 1 : priority];
+    u_int burst = p->p_time.usermode_time + p->p_time.kernelmode_time - p->p_cpu_time;
+
+    // Split in two terms to avoid the overflow of burst * FAIR_WEIGHT_UNIT
+    return ((burst / weight) * FAIR_WEIGHT_UNIT + (burst % weight) * FAIR_WEIGHT_UNIT / weight);
+}
+
+
+/*
+    Charges the CPU time used since the last time the process was added to the ready
+    queue to its virtual runtime, scaled by the weight of its priority
+
+    p: the process being added to the ready queue
+    return: void
+*/
+HIDDEN inline void fair_account(pcb_t *p) {
+    p->p_vruntime += fair_burst(p);
+    p->p_cpu_time = p->p_time.usermode_time + p->p_time.kernelmode_time;
+    p->p_heapkey = p->p_vruntime;
+}
+
+
+HIDDEN inline void sched_init(void) { mkEmptyPcbHeap(&ready_heap); }
+HIDDEN inline void sched_enqueue(pcb_t *p) { insertPcbHeap(&ready_heap, p); }
+HIDDEN inline pcb_t* sched_dequeue(pcb_t *p) { return (outPcbHeap(&ready_heap, p)); }
+HIDDEN inline int sched_empty(void) { return (emptyPcbHeap(&ready_heap)); }
+
+// In the heap each insertion is already O(log n)
+HIDDEN inline void sched_enqueue_all(struct list_head *procs) {
+    while (! list_empty(procs)) {
+        pcb_t *p = container_of(list_next(procs), pcb_t, p_next);
+        list_del(&p->p_next);
+        insertPcbHeap(&ready_heap, p);
+    }
+}
+
+// The virtual runtime of the others can't go back before the one of the chosen (the lowest)
+HIDDEN inline pcb_t* sched_pick_next(void) {
+    pcb_t *next = removePcbHeap(&ready_heap);
+
+    if ((int)(next->p_vruntime - min_vruntime) > 0)
+        min_vruntime = next->p_vruntime;
+
+    return (next);
+}
+
+
+HIDDEN inline void sched_tick(pcb_t *p) { fair_account(p); }
+
+// A new process starts from the lowest virtual runtime dispatched, a waken up one at most FAIR_SLEEPER_CREDIT before it
+HIDDEN inline void sched_wakeup(pcb_t *p, u_int first) {
+    fair_account(p);
+
+    if (first)
+        p->p_vruntime = min_vruntime;
+    else if ((int)(p->p_vruntime - (min_vruntime - FAIR_SLEEPER_CREDIT)) < 0)
+        p->p_vruntime = min_vruntime - FAIR_SLEEPER_CREDIT;
+
+    p->p_heapkey = p->p_vruntime;
+}
+
+// A process that yields goes after the ready one with the lowest virtual runtime
+HIDDEN inline void sched_yield(pcb_t *p) {
+    pcb_t *head = headPcbHeap(&ready_heap);
+
+    if (head != NULL && (int)(p->p_vruntime - head->p_vruntime) <= 0)
+        p->p_vruntime = head->p_vruntime + 1;
+
+    p->p_heapkey = p->p_vruntime;
+}
+
+// The priority only sets the weight, no aging is needed
+HIDDEN inline int sched_priority(pcb_t *p) { return (mutex_priority(p)); }
+HIDDEN inline u_int sched_quantum(pcb_t *p) { return (TIME_SLICE); }
+
+// The heap key is compared, the running process is charged (only here) with the time used so far
+HIDDEN inline int sched_preempts(pcb_t *p, pcb_t *cur) {
+    return ((int)(p->p_vruntime + FAIR_WAKEUP_GRAN - (cur->p_vruntime + fair_burst(cur))) < 0);
+}
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef __SCHED_MLFQ_H
+#define __SCHED_MLFQ_H
+
+#include "../include/types_bikaya.h"
+#include "sched_readyq.h"
+#include "mutex.h"
+
+/*
+    Multilevel feedback queue class: a process that uses the whole quantum of its level
+    (CPU bound) goes down a level, with a lower priority and a doubled quantum, while
+    one that blocks after a small part of it (I/O bound) goes up a level. The levels
+    are a priority bonus in the aged ready queue, so the aging still crosses them.
+*/
+
+// Number of levels of the multilevel feedback queue, the top one is 0
+#define MLFQ_LEVELS 4
+// Priority gap between two adjacent levels (the aging can still cross it, so nobody starves)
+#define MLFQ_LEVEL_GAP 4
+// Quantum of a level, it doubles at each level going down
+#define MLFQ_QUANTUM(level) (TIME_SLICE << (level))
+// A process that blocks before using this fraction of its quantum is promoted
+#define MLFQ_PROMOTE_DIV 4
+
+
+// The original priority raised by inheritance and by the level
+HIDDEN inline int sched_priority(pcb_t *p) {
+    return (mutex_priority(p) + (MLFQ_LEVELS - 1 - p->mlfq_level) * MLFQ_LEVEL_GAP);
+}
+
+// What is left of the quantum of the level
+HIDDEN inline u_int sched_quantum(pcb_t *p) {
+    return (MLFQ_QUANTUM(p->mlfq_level) - p->mlfq_used);
+}
+
+
+/*
+    Charges the CPU time used since the last time the process was added to the ready queue
+    to its level, moving it down or up. The time is summed across preemptions, so blocking
+    just before the end of the quantum doesn't help.
+
+    p: the process being added to the ready queue
+    preempted: TRUE if the process was running (put back in the queue), FALSE if waken up
+    return: void
+*/
+HIDDEN inline void mlfq_account(pcb_t *p, u_int preempted) {
+    u_int cpu_time = p->p_time.usermode_time + p->p_time.kernelmode_time;
+    u_int quantum = MLFQ_QUANTUM(p->mlfq_level);
+    u_int burst = cpu_time - p->p_cpu_time;
+
+    p->p_cpu_time = cpu_time;
+    p->mlfq_used += burst;
+
+    if (p->mlfq_used >= quantum) {
+        p->mlfq_level += (p->mlfq_level < MLFQ_LEVELS - 1);
+        p->mlfq_used = 0;
+    }
+    else if (! preempted && burst < quantum / MLFQ_PROMOTE_DIV && p->mlfq_level > 0) {
+        p->mlfq_level--;
+        p->mlfq_used = 0;
+    }
+
+    p->priority = sched_priority(p);
+}
+
+
+HIDDEN inline void sched_init(void) { readyq_init(); }
+HIDDEN inline void sched_enqueue(pcb_t *p) { readyq_insert(p); }
+HIDDEN inline void sched_enqueue_all(struct list_head *procs) { readyq_insert_all(procs); }
+HIDDEN inline pcb_t* sched_dequeue(pcb_t *p) { return (readyq_remove(p)); }
+HIDDEN inline pcb_t* sched_pick_next(void) { return (readyq_next()); }
+HIDDEN inline int sched_empty(void) { return (readyq_empty()); }
+
+HIDDEN inline void sched_tick(pcb_t *p) { mlfq_account(p, TRUE); }
+HIDDEN inline void sched_wakeup(pcb_t *p, u_int first) { mlfq_account(p, FALSE); }
+// The ready queue already puts a process after the ones with the same priority
+HIDDEN inline void sched_yield(pcb_t *p) { }
+
+// The priority is the key of the ready queue (aged), the running process is compared with the one it would have now (level, inherited)
+HIDDEN inline int sched_preempts(pcb_t *p, pcb_t *cur) { return (p->priority >= sched_priority(cur) + PREEMPT_MARGIN); }
+
+#endif
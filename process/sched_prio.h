@@ -0,0 +1,33 @@
+#ifndef __SCHED_PRIO_H
+#define __SCHED_PRIO_H
+
+#include "../include/types_bikaya.h"
+#include "sched_readyq.h"
+#include "mutex.h"
+
+/*
+    Default scheduling class: the process with the highest priority is executed, the
+    excluded ones are aged at each dispatch, and everyone gets the same time slice
+*/
+
+HIDDEN inline void sched_init(void) { readyq_init(); }
+HIDDEN inline void sched_enqueue(pcb_t *p) { readyq_insert(p); }
+HIDDEN inline void sched_enqueue_all(struct list_head *procs) { readyq_insert_all(procs); }
+HIDDEN inline pcb_t* sched_dequeue(pcb_t *p) { return (readyq_remove(p)); }
+HIDDEN inline pcb_t* sched_pick_next(void) { return (readyq_next()); }
+HIDDEN inline int sched_empty(void) { return (readyq_empty()); }
+
+// The priority doesn't depend on the CPU time used
+HIDDEN inline void sched_tick(pcb_t *p) { }
+HIDDEN inline void sched_wakeup(pcb_t *p, u_int first) { }
+// The ready queue already puts a process after the ones with the same priority
+HIDDEN inline void sched_yield(pcb_t *p) { }
+
+// The original priority raised by inheritance, the aging is lost at each dispatch
+HIDDEN inline int sched_priority(pcb_t *p) { return (mutex_priority(p)); }
+HIDDEN inline u_int sched_quantum(pcb_t *p) { return (TIME_SLICE); }
+
+// The priority is the key of the ready queue (aged), the running process is compared with the one it would have now (inherited)
+HIDDEN inline int sched_preempts(pcb_t *p, pcb_t *cur) { return (p->priority >= sched_priority(cur) + PREEMPT_MARGIN); }
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef __SCHED_READYQ_H
+#define __SCHED_READYQ_H
+
+#include "../include/types_bikaya.h"
+#include "pcb.h"
+
+/*
+    Ready queue sorted by priority with aging, shared by the classes that schedule by
+    priority: at each dispatch all the excluded processes get one more point of priority
+*/
+
+HIDDEN struct list_head ready_queue;
+
+
+HIDDEN inline void readyq_init(void) {
+    mkEmptyProcQ(&ready_queue);
+}
+
+HIDDEN inline void readyq_insert(pcb_t *p) {
+    insertProcQ(&ready_queue, p);
+}
+
+// The process is in the queue (the scheduler keeps track of it), so it's removed without a scan
+HIDDEN inline pcb_t* readyq_remove(pcb_t *p) {
+    list_del_init(&p->p_next);
+    return (p);
+}
+
+HIDDEN inline int readyq_empty(void) {
+    return (emptyProcQ(&ready_queue));
+}
+
+
+/*
+    Inserts a list of processes with a single pass, they are sorted by priority in a
+    local queue and then merged in the ready queue
+
+    procs: the list of the PCBs to be added (linked by p_next), empty at the end
+    return: void
+*/
+HIDDEN inline void readyq_insert_all(struct list_head *procs) {
+    LIST_HEAD(sorted);
+
+    while (! list_empty(procs)) {
+        pcb_t *p = container_of(list_next(procs), pcb_t, p_next);
+        list_del(&p->p_next);
+        insertProcQ(&sorted, p);
+    }
+
+    mergeProcQ(&ready_queue, &sorted);
+}
+
+
+/*
+    Removes the process with the highest priority and simply increment by one the
+    priority of all the excluded
+
+    return: the process to be executed
+*/
+HIDDEN inline pcb_t* readyq_next(void) {
+    pcb_t *next = removeProcQ(&ready_queue);
+    struct list_head *tmp = NULL;
+
+    // The chosen one is unlinked as an empty list, it isn't in the queue anymore
+    if (next != NULL)
+        INIT_LIST_HEAD(&next->p_next);
+
+    list_for_each(tmp, &ready_queue) {
+        pcb_t *currentPCB = container_of(tmp, pcb_t, p_next);
+        currentPCB->priority++;
+    }
+
+    return (next);
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef __SCHED_STRIDE_H
+#define __SCHED_STRIDE_H
+
+#include "../include/types_bikaya.h"
+#include "pcb.h"
+#include "mutex.h"
+
+/*
+    Stride scheduling class: each process holds a number of tickets (SETTICKETS) and its
+    pass advances by its stride, STRIDE_ONE / tickets, for each clock of CPU it uses. The
+    ready processes are kept in a heap sorted by pass and the lowest one runs, so under
+    contention the CPU is split exactly in the ratios of the tickets.
+*/
+
+// Stride of a process with a single ticket (per clock of CPU)
+#define STRIDE_ONE 1024
+// Pass a waken up process must be behind the running one to preempt it (a quarter of slice with the default tickets)
+#define STRIDE_WAKEUP_GRAN ((TIME_SLICE / 4) / STRIDE_DEFAULT_TICKETS * STRIDE_ONE)
+
+// Ready processes sorted by pass, and the lowest pass dispatched so far (the global pass)
+HIDDEN pcb_heap_t ready_heap;
+HIDDEN u_int global_pass = 0;
+
+
+// Returns the tickets of a process, the ones that haven't been set get the default
+HIDDEN inline u_int stride_tickets(pcb_t *p) {
+    return (p->p_tickets ? p->p_tickets : STRIDE_DEFAULT_TICKETS);
+}
+
+
+// Returns the pass advance for the CPU time used since the last time the process was charged
+HIDDEN inline u_int stride_burst(pcb_t *p) {
+    u_int tickets = stride_tickets(p);
+    u_int burst = p->p_time.usermode_time + p->p_time.kernelmode_time - p->p_cpu_time;
+
+    // Split in two terms to avoid the overflow of burst * STRIDE_ONE
+    return ((burst / tickets) * STRIDE_ONE + (burst % tickets) * STRIDE_ONE / tickets);
+}
+
+
+/*
+    Advances the pass of a process by its stride for each clock of CPU used since the
+    last time it was added to the ready queue
+
+    p: the process being added to the ready queue
+    return: void
+*/
+HIDDEN inline void stride_account(pcb_t *p) {
+    p->p_pass += stride_burst(p);
+    p->p_cpu_time = p->p_time.usermode_time + p->p_time.kernelmode_time;
+    p->p_heapkey = p->p_pass;
+}
+
+
+HIDDEN inline void sched_init(void) { mkEmptyPcbHeap(&ready_heap); }
+HIDDEN inline void sched_enqueue(pcb_t *p) { insertPcbHeap(&ready_heap, p); }
+HIDDEN inline pcb_t* sched_dequeue(pcb_t *p) { return (outPcbHeap(&ready_heap, p)); }
+HIDDEN inline int sched_empty(void) { return (emptyPcbHeap(&ready_heap)); }
+
+HIDDEN inline void sched_enqueue_all(struct list_head *procs) {
+    while (! list_empty(procs)) {
+        pcb_t *p = container_of(list_next(procs), pcb_t, p_next);
+        list_del(&p->p_next);
+        insertPcbHeap(&ready_heap, p);
+    }
+}
+
+HIDDEN inline pcb_t* sched_pick_next(void) {
+    pcb_t *next = removePcbHeap(&ready_heap);
+
+    if ((int)(next->p_pass - global_pass) > 0)
+        global_pass = next->p_pass;
+
+    return (next);
+}
+
+
+HIDDEN inline void sched_tick(pcb_t *p) { stride_account(p); }
+
+// A process that was blocked (or is new) doesn't keep the credit of the time it hasn't run
+HIDDEN inline void sched_wakeup(pcb_t *p, u_int first) {
+    stride_account(p);
+
+    if (first || (int)(p->p_pass - global_pass) < 0)
+        p->p_pass = global_pass;
+
+    p->p_heapkey = p->p_pass;
+}
+
+// A process that yields goes after the ready one with the lowest pass
+HIDDEN inline void sched_yield(pcb_t *p) {
+    pcb_t *head = headPcbHeap(&ready_heap);
+
+    if (head != NULL && (int)(p->p_pass - head->p_pass) <= 0)
+        p->p_pass = head->p_pass + 1;
+
+    p->p_heapkey = p->p_pass;
+}
+
+// The priority isn't used to choose, only the tickets
+HIDDEN inline int sched_priority(pcb_t *p) { return (mutex_priority(p)); }
+HIDDEN inline u_int sched_quantum(pcb_t *p) { return (TIME_SLICE); }
+
+// The heap key is compared, the running process is charged (only here) with the time used so far
+HIDDEN inline int sched_preempts(pcb_t *p, pcb_t *cur) {
+    return ((int)(p->p_pass + STRIDE_WAKEUP_GRAN - (cur->p_pass + stride_burst(cur))) < 0);
+}
+
+#endif
@@ -1,10 +1,15 @@
 #include "../devices/interval_timer_utils.h"
+#include "../devices/disk_utils.h"
 #include "../include/types_bikaya.h"
 #include "../include/system_const.h"
 #include "../generics/utils.h"
+#include "../generics/event_log.h"
 #include "scheduler.h"
 #include "asl.h"
 #include "pcb.h"
+#include "mutex.h"
+#include "group.h"
+#include "sched_class.h"
 
 
 #ifdef TARGET_UMPS
@@ -15,32 +20,134 @@
 #endif
 
 
-// Ready queue of the scheduler
-struct list_head ready_queue;
 // Current process selected to be executed
 pcb_t *currentProcess = NULL;
 // The idle state let the processor active
 state_t idleState;
+// Set when a process is waken up with a priority high enough to preempt the current one
+HIDDEN u_int preempt_pending = FALSE;
 
 
 
+HIDDEN void idle(void) { while(1) ; }
+
+
+/* Ready processes operations, the real-time ones are in the EDF class ahead of the others */
+
+HIDDEN inline int ready_empty(void) {
+    return (edf_empty() && sched_empty());
+}
+
+HIDDEN inline void ready_insert(pcb_t *p) {
+    edf_task(p) ? edf_enqueue(p) : sched_enqueue(p);
+    // A real-time process that has used its budget sleeps till its release instead
+    p->p_ready = ! (edf_task(p) && p->p_edf.throttled);
+}
+
+// Checked on the flag, a pid given by a process could be a free PCB (p_next links the free list)
+HIDDEN inline pcb_t* ready_remove(pcb_t *p) {
+    pcb_t *removed = NULL;
+
+    if (p->p_ready && (removed = edf_task(p) ? edf_dequeue(p) : sched_dequeue(p)) != NULL)
+        p->p_ready = FALSE;
+
+    return (removed);
+}
+
+HIDDEN inline pcb_t* ready_next(void) {
+    pcb_t *next = edf_empty() ? sched_pick_next() : edf_pick_next();
+
+    (next != NULL) ? (next->p_ready = FALSE) : 0;
+    return (next);
+}
+
+// Inserts a process in the ready queue, unless its group has used the whole quota (it's throttled)
+HIDDEN inline void enqueue(pcb_t *p) {
+    group_exhausted(p) ? group_throttle(p) : ready_insert(p);
+}
+
+
 /*
-    This function is called by the scheduler after a process is chosen
-    for the execution and simply increment by one the priority of all the excluded
+    Checks if a waken up process (already in the ready queue) must preempt the current
+    one: a real-time process preempts the others and the ones with a later deadline, the
+    others are compared by the scheduling class with the key it chooses them by (the
+    priority, with the inherited one, must exceed the current one's by PREEMPT_MARGIN)
+
+    p: the waken up process
+    return: TRUE if the current process must be preempted
+*/
+HIDDEN u_int preempts(pcb_t *p) {
+    if (PREEMPT_MARGIN <= 0 || currentProcess == NULL || p == currentProcess || p->p_throttled)
+        return (FALSE);
+
+    if (edf_task(currentProcess))
+        return (edf_task(p) && ! p->p_edf.throttled &&
+                EDF_BEFORE(p->p_edf.abs_deadline, currentProcess->p_edf.abs_deadline));
+
+    if (edf_task(p))
+        return (! p->p_edf.throttled);
+
+    return (sched_preempts(p, currentProcess));
+}
 
+
+// Keeps the time slice left to the current process (read from the timer) for the next dispatch
+HIDDEN inline void keep_quantum(u_int left) {
+    currentProcess->p_quantum_left = ((int) left > 0) ? left : 0;
+}
+
+
+/*
+    Prepares a process to be inserted in the ready queue: the original priority and the time
+    stats are set the first time, after the priority can be raised by inheritance
+
+    p: the process to be added
     return: void
 */
-HIDDEN void aging(void) {
-    struct list_head *tmp = NULL;
+HIDDEN void make_ready(pcb_t *p) {
+    u_int first = ! p->p_time.activation_time;
 
-    list_for_each(tmp, &ready_queue) {
-        pcb_t *currentPCB = container_of(tmp, pcb_t, p_next);
-        currentPCB->priority++;
-    }
+    if (first)
+        p->original_priority = p->priority;
+
+    // Initialize the time_t struct if it's added for the first time
+    init_time(&p->p_time);
+
+    // The CPU time used so far is charged by the scheduling class (by the EDF one on insertion)
+    if (edf_task(p))
+        return ;
+    else if (p == currentProcess)
+        sched_tick(p);
+    else
+        sched_wakeup(p, first);
 }
 
 
-HIDDEN void idle(void) { while(1) ; }
+/*
+    Executes the given process (already removed from the ready queue): restores its
+    priority and loads its state with the time slice given by the scheduling class, the
+    one left when it was preempted or the one donated by another process
+
+    next: the process to be executed
+    quantum: the time slice donated to the process, 0 to use its own
+    return: void
+*/
+HIDDEN void dispatch(pcb_t *next, u_int quantum) {
+    currentProcess = next;
+    currentProcess->priority = sched_priority(currentProcess);
+    preempt_pending = FALSE;
+    LOG_EVENT(EV_DISPATCH, currentProcess, currentProcess->priority);
+
+    //Set the new "time breakpoint"
+    currentProcess->p_time.last_update_time = TOD_LO;
+
+    // Loads the state and executes the chosen process but before sets the time slice
+    quantum = quantum ? quantum : currentProcess->p_quantum_left;
+    quantum = quantum ? quantum : sched_quantum(currentProcess);
+    currentProcess->p_quantum_left = 0;
+    setTimerTo(group_quantum(currentProcess, edf_quantum(currentProcess, quantum, TOD_LO)));
+    LDST(&currentProcess->p_s);
+}
 
 
 /*
@@ -54,7 +161,9 @@ void scheduler_init(void) {
     initPcbs();
     initASL();
     currentProcess = NULL;
-    mkEmptyProcQ(&ready_queue);
+    sched_init();
+    edf_init();
+    initGroups();
 
     // Sets the idle state option
     process_option idle_opt = IDLE_OPTION;
@@ -65,65 +174,368 @@ void scheduler_init(void) {
 
 
 /*
-    Adds a new process to the scheduler, checks the arguments first
+    Adds a new process to the scheduler, checks the arguments first. If the process
+    must preempt the current one the preemption is left pending till the end of the
+    syscall or interrupt (see scheduler_preempt and scheduler_resume).
 
     p: the PCB pointer to be added to the scheduler
     return: void
 */
 void scheduler_add(pcb_t *p) {
     if (p != NULL) {
-        // Initialize the time_t struct if it's added for the first time
-        init_time(&p->p_time);
-        p->original_priority = p->priority;
-        insertProcQ(&ready_queue, p);
+        make_ready(p);
+        enqueue(p);
+        preempt_pending |= preempts(p);
+    }
+}
+
+
+/*
+    Adds a batch of processes to the scheduler at once, the scheduling class can insert
+    them with a single pass (the priority queue merges them)
+
+    procs: the list of the PCBs to be added (linked by p_next), empty at the end
+    return: void
+*/
+void scheduler_add_all(struct list_head *procs) {
+    struct list_head *tmp, *next;
+
+    for (tmp = list_next(procs); tmp != procs; tmp = next) {
+        pcb_t *p = container_of(tmp, pcb_t, p_next);
+        next = tmp->next;
+        make_ready(p);
+
+        // The real-time and throttled processes are set apart, the others are inserted all together
+        if (edf_task(p) || group_exhausted(p)) {
+            list_del(tmp);
+            enqueue(p);
+            preempt_pending |= preempts(p);
+        }
+    }
+
+    // The others are checked before the class empties the list inserting them
+    for (tmp = list_next(procs); tmp != procs; tmp = tmp->next) {
+        pcb_t *p = container_of(tmp, pcb_t, p_next);
+        p->p_ready = TRUE;
+        preempt_pending |= preempts(p);
     }
+
+    sched_enqueue_all(procs);
+}
+
+
+/*
+    Removes a process from the scheduler (used when the process is killed), also
+    releasing its real-time utilisation (a sleeping real-time one is removed by the
+    EDF class) and leaving its group
+
+    p: the process to be removed
+    return: the process, NULL if it wasn't in the ready queue (or throttled by its group)
+*/
+pcb_t* scheduler_remove(pcb_t *p) {
+    pcb_t *removed = p;
+
+    edf_exit(p);
+    if (p->p_throttled)
+        group_unthrottle(p);
+    else
+        removed = ready_remove(p);
+
+    group_join(p, NULL);
+    return (removed);
+}
+
+
+/*
+    Moves a process in a group (or out of any with NULL), a throttled process is
+    released from the old group and throttled again only if the new one is exhausted
+
+    p: the process
+    group: the new group
+    return: void
+*/
+void scheduler_set_group(pcb_t *p, group_t *group) {
+    u_int throttled = p->p_throttled;
+
+    throttled ? group_unthrottle(p) : 0;
+    group_join(p, group);
+    throttled ? enqueue(p) : 0;
+}
+
+
+/*
+    Sets the priority of a process (raised or lowered by inheritance), if the process
+    is in the ready queue it's moved to keep the queue sorted, if it's blocked it's moved
+    in the semaphore queues sorted by priority. Both are found without scanning a queue.
+    A real-time process is sorted by deadline and stays where it is (ready or sleeping).
+
+    p: the process
+    priority: the new priority
+    return: void
+*/
+void scheduler_set_priority(pcb_t *p, int priority) {
+    u_int ready = (p != currentProcess && p->p_semkey == NULL && ! p->p_throttled && ! edf_task(p) &&
+                   ready_remove(p) != NULL);
+
+    p->priority = priority;
+
+    if (ready) {
+        ready_insert(p);
+        preempt_pending |= preempts(p);
+    }
+    else if (p->p_semkey != NULL)
+        requeueBlocked(p);
+}
+
+
+/*
+    Sets the base priority of a process (the one it gets back when it doesn't inherit
+    any from the mutexes it owns) and updates its current priority. If the process is
+    waiting on a mutex the owner inherits the new priority, if higher.
+
+    p: the process
+    priority: the new base priority
+    return: void
+*/
+void scheduler_set_base_priority(pcb_t *p, int priority) {
+    p->original_priority = priority;
+    scheduler_set_priority(p, sched_priority(p));
+
+    if (p->p_semkey != NULL)
+        mutex_wait(p->p_semkey, p);
 }
 
 
 /*
     The scheduler main function, each time that is called put back the currentProc in
-    the ready queue and the chose a new process to be executed. If the ready queue is 
-    empty then HALT the system else load the chosen process but before ages the priority
-    of the excluded and set the currentProc timeslice
+    the ready queue and the chose a new process to be executed (a real-time one first).
+    If no process is left then HALT the system, if they are all waiting then idle.
 */
 void scheduler(void) {
+    LOG_DRAIN();
+
+    // If a process executed before puts it back in the queue (a real-time one can be throttled)
+    if (currentProcess != NULL) {
+        update_time(USR_MD_TIME, TOD_LO);
+        scheduler_add(currentProcess);
+        currentProcess = NULL;
+    }
+
+    // The processes of a group that has used the whole quota are throttled when they are chosen
+    pcb_t *next = NULL;
+    while (next == NULL && ! ready_empty()) {
+        next = ready_next();
+
+        if (group_exhausted(next)) {
+            group_throttle(next);
+            next = NULL;
+        }
+    }
+
     // If there isn't process in ready_queue nor ASL then there's no process at all (shuts off)
-    if (emptyProcQ(&ready_queue) && emptyASL() && currentProcess == NULL) {
+    if (next == NULL && emptyASL() && ! edf_waiting() && ! group_any_throttled()) {
+        // The blocks still in the disk cache are written back before, idling till the flush is done
+        if (disk_cache_flush())
+            LDST(&idleState);
+
         print_debug_terminal("No more process to be executed, shutting off!");
         HALT();
     }
     
     // If no process is ready then idle the process till one is (idle has all interrupt enabled)
-     if (emptyProcQ(&ready_queue) && currentProcess == NULL)
-       LDST(&idleState);
-    
-    else {
-        // If a process executed before puts it back in the queue
-        if (currentProcess != NULL) {
-            update_time(USR_MD_TIME, TOD_LO);
-            scheduler_add(currentProcess);
-        }
-        
-        // Extracts a new process, restores its priority and ages all the excluded
-        currentProcess = removeProcQ(&ready_queue);
-        currentProcess->priority = currentProcess->original_priority;
-        aging();
-
-        //Set the new "time breakpoint"
-        currentProcess->p_time.last_update_time = TOD_LO;
-
-        // Loads the state and executes the chosen process but before sets the time slice
-        setIntervalTimer();
-        LDST(&currentProcess->p_s);
+    if (next == NULL) {
+        // Wakes up in time for the next real-time release
+        edf_waiting() ? setTimerTo(edf_quantum(NULL, TIME_SLICE, TOD_LO)) : 0;
+        LDST(&idleState);
     }
+
+    // Executes the chosen process
+    dispatch(next, 0);
 }
 
 
-// Returns a pointer to the ready queue
-extern inline struct list_head* getReadyQ(void) {
-    return(&ready_queue);
+/*
+    Switches straight to the given ready process, without choosing it from the ready queue
+    (used for the handoff on V). The current process is put back in the ready queue.
+
+    next: the process to be executed, in the ready queue
+    return: void
+*/
+void scheduler_handoff(pcb_t *next) {
+    // A process of an exhausted group can't run, it's left to the scheduler to throttle it,
+    // as a real-time one that used its budget (it's waiting for its next release)
+    if (group_exhausted(next) || ready_remove(next) == NULL)
+        scheduler();
+
+    // The preempted process will get back the rest of its time slice
+    if (currentProcess != NULL) {
+        keep_quantum(getIntervalTimer());
+        update_time(USR_MD_TIME, TOD_LO);
+        scheduler_add(currentProcess);
+    }
+
+    dispatch(next, 0);
 }
 
+
+/*
+    Resumes the current process after an interrupt that didn't end its time slice, so
+    that a device interrupt doesn't cost it the rest of the slice (and a place in the
+    queue). The time spent in the handler isn't charged to the slice. If no process was
+    executing or the slice is over the scheduler chooses another one, as when a process
+    waken up by the interrupt preempts the current one (that keeps the time left).
+
+    quantum_left: the time slice left, read from the timer when the interrupt was raised
+    return: void
+*/
+void scheduler_resume(u_int quantum_left) {
+    LOG_DRAIN();
+
+    if (currentProcess == NULL || (int) quantum_left <= 0)
+        scheduler();
+
+    if (preempt_pending) {
+        keep_quantum(quantum_left);
+        scheduler();
+    }
+
+    setTimerTo(quantum_left);
+    LDST(&currentProcess->p_s);
+}
+
+
+/*
+    Returns TRUE if the given ready process goes before the current one in the order of the
+    scheduling class (or by deadline), as a waken up process that preempts it
+*/
+u_int scheduler_preempts(pcb_t *p) {
+    return (p != NULL && preempts(p));
+}
+
+
+/*
+    Returns TRUE if a process waken up since the current one was dispatched must preempt it
+*/
+u_int scheduler_must_preempt(void) {
+    return (preempt_pending && currentProcess != NULL);
+}
+
+
+/*
+    Preempts the current process in favour of the waken up one that has a higher priority,
+    the current process keeps the rest of its time slice for when it executes again.
+    NOTE: the state of the current process must be already saved!
+
+    return: void
+*/
+void scheduler_preempt(void) {
+    keep_quantum(getIntervalTimer());
+    scheduler();
+}
+
+
+/*
+    Puts the current process back in the ready queue behind its peers (the ones with the
+    same priority, or the next one by virtual runtime or pass)
+
+    return: void
+*/
+HIDDEN void yield_current(void) {
+    update_time(USR_MD_TIME, TOD_LO);
+    make_ready(currentProcess);
+
+    if (! edf_task(currentProcess))
+        sched_yield(currentProcess);
+
+    enqueue(currentProcess);
+    currentProcess = NULL;
+}
+
+
+/*
+    The current process gives up the rest of its time slice, it's put back in the ready
+    queue behind its peers and another process is chosen
+    NOTE: this function never returns to the caller!
+
+    return: void
+*/
+void scheduler_yield(void) {
+    if (currentProcess != NULL)
+        yield_current();
+
+    scheduler();
+}
+
+
+/*
+    The current process donates the rest of its time slice to the given ready process,
+    that is executed right away, then it's put back in the ready queue behind its peers.
+    If the time slice is already over the process runs with its own.
+    NOTE: this function returns to the caller only on failure!
+
+    next: the process to be executed
+    return: -1 if the process isn't ready (or is throttled)
+*/
+int scheduler_yield_to(pcb_t *next) {
+    u_int left = getIntervalTimer();
+
+    if (next == NULL || next == currentProcess || group_exhausted(next) || ready_remove(next) == NULL)
+        return (FAILURE);
+
+    if (currentProcess != NULL)
+        yield_current();
+
+    dispatch(next, ((int) left > 0) ? left : 0);
+    return (SUCCESS);
+}
+
+
+/*
+    Releases the real-time processes whose period has started and the throttled processes
+    whose group has quota again, called at each interrupt. As the waken up ones, they can
+    preempt the current process.
+
+    now: the current clock
+    return: void
+*/
+void scheduler_release(u_int now) {
+    LIST_HEAD(released);
+
+    edf_release(now, &released);
+    group_refill(now, &released);
+
+    while (! list_empty(&released)) {
+        pcb_t *p = container_of(list_next(&released), pcb_t, p_next);
+        list_del(&p->p_next);
+        ready_insert(p);
+        preempt_pending |= preempts(p);
+    }
+}
+
+
+/*
+    Sets the real-time parameters of a process (see edf_register)
+
+    p: the process, the current one
+    period, budget, deadline: the parameters in clocks, a deadline of 0 is the period
+    return: 0 on success, -1 if the parameters are invalid or the process isn't admitted
+*/
+int scheduler_edf_register(pcb_t *p, u_int period, u_int budget, u_int deadline) {
+    return (edf_register(p, period, budget, deadline, TOD_LO));
+}
+
+
+/*
+    Ends the current job of a real-time process, that waits for the next release
+
+    p: the real-time process, the current one
+    return: TRUE if the process has been put to sleep (another one must be dispatched)
+*/
+u_int scheduler_edf_wait(pcb_t *p) {
+    return (edf_wait(p, TOD_LO));
+}
+
+
 // Returns the current executing process
 extern inline pcb_t* getCurrentProc(void) {
     return(currentProcess);
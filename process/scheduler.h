@@ -5,8 +5,22 @@
 
 void scheduler_init(void);
 void scheduler_add(pcb_t *p);
+void scheduler_add_all(struct list_head *procs);
+pcb_t* scheduler_remove(pcb_t *p);
+void scheduler_set_group(pcb_t *p, group_t *group);
+void scheduler_set_priority(pcb_t *p, int priority);
+void scheduler_set_base_priority(pcb_t *p, int priority);
 void scheduler(void);
-struct list_head* getReadyQ(void);
+void scheduler_handoff(pcb_t *next);
+void scheduler_resume(u_int quantum_left);
+u_int scheduler_preempts(pcb_t *p);
+u_int scheduler_must_preempt(void);
+void scheduler_preempt(void);
+void scheduler_yield(void);
+int scheduler_yield_to(pcb_t *next);
+void scheduler_release(u_int now);
+int scheduler_edf_register(pcb_t *p, u_int period, u_int budget, u_int deadline);
+u_int scheduler_edf_wait(pcb_t *p);
 pcb_t* getCurrentProc(void);
 void setCurrentProc(pcb_t *proc);
 
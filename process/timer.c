@@ -0,0 +1,72 @@
+#include "../include/system_const.h"
+#include "../include/types_bikaya.h"
+#include "../include/listx.h"
+#include "scheduler.h"
+#include "asl.h"
+#include "timer.h"
+
+
+/*
+    The timer queue holds the processes blocked on a semaphore with a deadline (timed P),
+    sorted by deadline. The queue is checked on every interrupt, so a deadline expires
+    with the resolution of the time slice (the interval timer raises one at least).
+*/
+HIDDEN LIST_HEAD(timer_queue);
+
+// TRUE if the clock a comes before the clock b (the TOD_LO wrap around is considered)
+#define CLOCK_BEFORE(a, b) ((int)((a) - (b)) < 0)
+
+
+
+/*
+    Adds the process to the timer queue, after the ones with an earlier (or the same) deadline
+
+    p: the process waiting with a deadline
+    deadline: the clock after wich the wait expires
+    return: void
+*/
+void timer_add(pcb_t *p, u_int deadline) {
+    struct list_head *pos;
+    p->p_deadline = deadline;
+
+    list_for_each(pos, &timer_queue) 
+        if (CLOCK_BEFORE(deadline, container_of(pos, pcb_t, p_timer)->p_deadline))
+            break;
+
+    list_add_tail(&p->p_timer, pos);
+}
+
+
+/*
+    Removes the process from the timer queue in constant time, called when the process
+    leaves the semaphore (waken up or killed) before the deadline
+
+    p: the process
+    return: void
+*/
+void timer_cancel(pcb_t *p) {
+    if (! list_empty(&p->p_timer))
+        list_del_init(&p->p_timer);
+}
+
+
+/*
+    Wakes up the processes whose deadline has expired, they are removed from the semaphore
+    and get the TIMEOUT return value from the timed P
+
+    current_clock: the current value of the TOD_LO
+    return: void
+*/
+void timer_expire(u_int current_clock) {
+    while (! list_empty(&timer_queue)) {
+        pcb_t *p = container_of(list_next(&timer_queue), pcb_t, p_timer);
+
+        if (CLOCK_BEFORE(current_clock, p->p_deadline))
+            return ;
+
+        list_del_init(&p->p_timer);
+        outBlocked(p);
+        SYS_RETURN_VAL(((state_t*) &p->p_s)) = TIMEOUT;
+        scheduler_add(p);
+    }
+}
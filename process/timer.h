@@ -0,0 +1,10 @@
+#ifndef __TIMER_H
+#define __TIMER_H
+
+#include "../include/types_bikaya.h"
+
+void timer_add(pcb_t *p, u_int deadline);
+void timer_cancel(pcb_t *p);
+void timer_expire(u_int current_clock);
+
+#endif
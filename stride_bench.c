@@ -0,0 +1,134 @@
+/*
+    Benchmark of the stride scheduling, it replaces the phase 2 test as init process when
+    the kernel is built with -D SCHED_POLICY=stride -D STRIDE_BENCH=ON.
+
+    BENCH_WORKERS CPU bound processes, with tickets in the ratios of bench_tickets, spin
+    together for BENCH_TIME clocks. Then each one reports on terminal 0 the usermode time
+    it got and its share of the total against the share expected from the tickets (both
+    per mille), so it's easy to see how closely the measured time tracks the tickets.
+*/
+#ifdef TARGET_UMPS
+#include "./include/uMPS/libumps.h"
+#include "./include/uMPS/arch.h"
+#include "./include/uMPS/types.h"
+#endif
+
+#ifdef TARGET_UARM
+#include "./include/uARM/uarm/libuarm.h"
+#include "./include/uARM/uarm/arch.h"
+#include "./include/uARM/uarm/uARMtypes.h"
+#endif
+
+#include "./include/system_const.h"
+#include "./include/types_bikaya.h"
+
+#define BENCH_WORKERS 4
+// Time the workers spin together (in clocks)
+#define BENCH_TIME    (300 * TIME_SLICE)
+// Length of the buffer used to print a number
+#define NUM_LEN       11
+
+// From the phase 2 test, linked in the kernel as well
+void print(char *msg);
+unsigned int set_sp_pc_status(state_t *s, state_t *copy, unsigned int pc, unsigned int frames);
+
+HIDDEN const unsigned int bench_tickets[BENCH_WORKERS] = { 100, 200, 300, 400 };
+
+HIDDEN state_t worker_state[BENCH_WORKERS];
+HIDDEN void *worker_pid[BENCH_WORKERS];
+// Usermode time of each worker while spinning
+HIDDEN unsigned int worker_time[BENCH_WORKERS];
+
+// Semaphores to start the workers, to know that they are done and to let the init process sleep
+int bench_start = 0, bench_done = 0, bench_sleep = 0;
+// Set by the init process when the time is up
+volatile int bench_stop = 0;
+
+
+// Prints an unsigned number on terminal 0
+HIDDEN void print_num(unsigned int n) {
+    char buf[NUM_LEN];
+    int i = NUM_LEN - 1;
+
+    buf[i] = '\0';
+    do {
+        buf[--i] = '0' + n % 10;
+        n /= 10;
+    } while (n > 0);
+
+    print(&buf[i]);
+}
+
+
+// Spins till the init process sets bench_stop, then reports its usermode time
+HIDDEN void worker(void) {
+    unsigned int user_start, user_end, kernel, wallclock;
+    void *pid = NULL;
+    int index = 0;
+
+    SYSCALL(PASSEREN, (int)&bench_start, 0, 0);
+
+    // The pids are all set once the workers are started
+    SYSCALL(GETPID, (int)&pid, 0, 0);
+    while (worker_pid[index] != pid)
+        index++;
+
+    SYSCALL(GETCPUTIME, (int)&user_start, (int)&kernel, (int)&wallclock);
+    while (! bench_stop)
+        ;
+    SYSCALL(GETCPUTIME, (int)&user_end, (int)&kernel, (int)&wallclock);
+
+    worker_time[index] = user_end - user_start;
+    SYSCALL(VERHOGEN, (int)&bench_done, 0, 0);
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
+
+
+// Init process of the benchmark
+void stride_bench(void) {
+    unsigned int total_time = 0, total_tickets = 0;
+
+    print("stride benchmark starts\n");
+
+    for (int i = 0; i < BENCH_WORKERS; i++) {
+        set_sp_pc_status(&worker_state[i], (i == 0) ? &worker_state[0] : &worker_state[i - 1], (unsigned int)worker, 1);
+
+        if (SYSCALL(CREATEPROCESS, (int)&worker_state[i], DEFAULT_PRIORITY, (int)&worker_pid[i]) ||
+            SYSCALL(SETTICKETS, (int)worker_pid[i], bench_tickets[i], 0)) {
+            print("error: can't create the workers\n");
+            PANIC();
+        }
+        total_tickets += bench_tickets[i];
+    }
+
+    // The init process has the most tickets, so it can stop the workers in time
+    SYSCALL(SETTICKETS, 0, STRIDE_MAX_TICKETS, 0);
+    for (int i = 0; i < BENCH_WORKERS; i++)
+        SYSCALL(VERHOGEN, (int)&bench_start, 0, 0);
+
+    // Sleeps with a timed P on a semaphore that nobody releases
+    SYSCALL(PASSERENTIMED, (int)&bench_sleep, BENCH_TIME, 0);
+    bench_stop = 1;
+
+    for (int i = 0; i < BENCH_WORKERS; i++)
+        SYSCALL(PASSEREN, (int)&bench_done, 0, 0);
+
+    for (int i = 0; i < BENCH_WORKERS; i++)
+        total_time += worker_time[i];
+
+    for (int i = 0; i < BENCH_WORKERS; i++) {
+        print("worker with ");
+        print_num(bench_tickets[i]);
+        print(" tickets: user time ");
+        print_num(worker_time[i]);
+        print(", share ");
+        // Divides the total first, the times in clocks would overflow
+        print_num(worker_time[i] / (total_time / 1000 + 1));
+        print(" expected ");
+        print_num(bench_tickets[i] * 1000 / total_tickets);
+        print(" (per mille)\n");
+    }
+
+    print("stride benchmark done\n");
+    SYSCALL(TERMINATEPROCESS, 0, 0, 0);
+}
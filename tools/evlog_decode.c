@@ -0,0 +1,71 @@
+/*
+    Host side decoder of the BiKayaOS binary event log, it reads a dump of the log
+    (the disk area set with the EVLOGDRAIN syscall or a memory dump of the ring)
+    and prints a line of text for each record. Records are little endian, as on
+    both uMPS and uARM, so the decoder must run on a little endian host.
+
+    Build: cc -o evlog_decode tools/evlog_decode.c
+    Usage: evlog_decode <dump file> [byte offset of the first record]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../generics/evlog_format.h"
+
+
+// Name and arguments description of each event, indexed by event id
+static const char *event_names[EV_NUM] = {
+    "none", "dispatch", "syscall", "interrupt", "block", "terminate", "disk_write", "log_drop"
+};
+
+static const char *event_args[EV_NUM] = {
+    "", "pcb=0x%08x priority=%u", "number=%u pcb=0x%08x", "line=%u pcb=0x%08x",
+    "semkey=0x%08x pcb=0x%08x", "pcb=0x%08x caller=0x%08x", "disk=%u block=%u", "dropped=%u"
+};
+
+
+int main(int argc, char *argv[]) {
+    evlog_record_t record;
+    unsigned long count = 0;
+    FILE *dump;
+
+    if (argc < 2 || argc > 3 || sizeof(evlog_record_t) != EVLOG_RECORD_SIZE) {
+        fprintf(stderr, "usage: %s <dump file> [byte offset]\n", argv[0]);
+        return (EXIT_FAILURE);
+    }
+
+    if ((dump = fopen(argv[1], "rb")) == NULL) {
+        perror(argv[1]);
+        return (EXIT_FAILURE);
+    }
+
+    // Device files start with a header, the offset lets the decoder skip it
+    if (argc == 3 && fseek(dump, strtol(argv[2], NULL, 0), SEEK_SET)) {
+        perror(argv[1]);
+        fclose(dump);
+        return (EXIT_FAILURE);
+    }
+
+    while (fread(&record, sizeof(record), 1, dump) == 1) {
+        // Unused records (never written or wiped) are skipped
+        if (record.id == EV_NONE)
+            continue;
+
+        printf("%10u  ", record.tod);
+
+        if (record.id < EV_NUM) {
+            printf("%-10s ", event_names[record.id]);
+            printf(event_args[record.id], record.arg[0], record.arg[1]);
+        }
+        else
+            printf("unknown(%u) 0x%08x 0x%08x", record.id, record.arg[0], record.arg[1]);
+
+        putchar('\n');
+        count++;
+    }
+
+    fprintf(stderr, "%lu records decoded\n", count);
+    fclose(dump);
+
+    return (EXIT_SUCCESS);
+}
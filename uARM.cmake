@@ -20,13 +20,15 @@ include_directories(${UARM_INC}/uarm)
 add_library(libuarm ${UARM_INC}/libuarm.s)
 add_library(libdiv ${UARM_INC}/libdiv.s)
 add_library(crtso ${UARM_INC}/crtso.s)
+add_library(usem ${GNR}/usem_uarm.s)
 
 add_executable(
 	kernel ${SRC}/phase2_test.c ${EXC}interrupt.c ${EXC}/syscall_bp.c ${EXC}/trap.c ${EXC}/tlb.c
-	${GNR}/utils.c ${PRC}/scheduler.c ${PRC}/pcb.c ${PRC}/asl.c ${DEV}/term_utils.c ${DEV}/interval_timer_utils.c
+	${GNR}/utils.c ${GNR}/event_log.c ${PRC}/scheduler.c ${PRC}/pcb.c ${PRC}/asl.c ${PRC}/mutex.c ${PRC}/timer.c ${PRC}/group.c ${DEV}/term_utils.c ${DEV}/interval_timer_utils.c ${DEV}/disk_utils.c ${DEV}/device_utils.c
+	${GNR}/usem.c ${BENCH_SRC}
 )
 
-target_link_libraries(kernel crtso libuarm libdiv)
+target_link_libraries(kernel crtso libuarm libdiv usem)
 
 add_custom_target(
 	kernel.core.uarm ALL
@@ -18,13 +18,15 @@ include_directories(${UMPS_INC}/umps)
 
 add_library(crtso ${UMPS_INC}/crtso.S)
 add_library(libumps ${UMPS_INC}/libumps.S)
+add_library(usem ${GNR}/usem_umps.S)
 
 add_executable(
 	kernel ${SRC}/phase2_test.c ${EXC}/interrupt.c ${EXC}/syscall_bp.c ${EXC}/trap.c ${EXC}/tlb.c
-	${GNR}/utils.c ${PRC}/scheduler.c ${PRC}/pcb.c ${PRC}/asl.c ${DEV}/term_utils.c ${DEV}/interval_timer_utils.c
+	${GNR}/utils.c ${GNR}/event_log.c ${PRC}/scheduler.c ${PRC}/pcb.c ${PRC}/asl.c ${PRC}/mutex.c ${PRC}/timer.c ${PRC}/group.c ${DEV}/term_utils.c ${DEV}/interval_timer_utils.c ${DEV}/disk_utils.c ${DEV}/device_utils.c
+	${GNR}/usem.c ${BENCH_SRC}
 )
 
-target_link_libraries(kernel crtso libumps)
+target_link_libraries(kernel crtso libumps usem)
 
 # Run the `umps2-elf2umps -k kernel' command after building `kernel'
 add_custom_target(